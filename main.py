@@ -3,22 +3,56 @@
 Main entry point for standalone Python testing of the AI Music Visualizer components.
 """
 
+import os
 import sys
+import json
+import time
 import argparse
-from src.python.audio_analyzer import AudioAnalyzer
-from src.python.mood_classifier import MoodClassifier
-from src.python.analysis_server import AnalysisServer
 
-def test_audio_analysis(file_path):
-    """Test audio analysis on a single file."""
-    analyzer = AudioAnalyzer()
+from src.python.model_cache import get_cache_dir, load_mood_classifier
+
+# Must be set before numba is first imported (via librosa) so compiled
+# functions are reused on the next launch instead of being JIT-compiled again
+os.environ.setdefault("NUMBA_CACHE_DIR", os.path.join(get_cache_dir(), "numba"))
+
+# librosa/torch imports take seconds, so each command imports only what it uses
+
+# Sample rate the mood classifier's features are computed at
+MOOD_SAMPLE_RATE = 22050
+
+def decode_audio(file_path, analyzer):
+    """Decode a track once for both analysis and mood classification.
+    
+    Returns ((audio, sr), (mood_audio, mood_sr)), or (None, None) if the file
+    cannot be loaded. Resampling is much cheaper than decoding (e.g. an mp3)
+    a second time.
+    """
+    import librosa
+    
+    audio_data, sr = analyzer.load_audio(file_path)
+    if audio_data is None:
+        return None, None
+    mood_audio = librosa.resample(audio_data, orig_sr=sr, target_sr=MOOD_SAMPLE_RATE)
+    return (audio_data, sr), (mood_audio, MOOD_SAMPLE_RATE)
+
+def test_audio_analysis(file_path, analyzer=None, plot=True, pyramid=False, audio=None):
+    """Test audio analysis on a single file. Returns the result, or None on error.
+    
+    audio is an already decoded (samples, sample_rate) pair for file_path.
+    """
+    if analyzer is None:
+        from src.python.audio_analyzer import AudioAnalyzer
+        analyzer = AudioAnalyzer()
     
     print(f"Analyzing {file_path}...")
-    result = analyzer.analyze_audio_file(file_path)
+    if audio is not None:
+        result = analyzer.analyze_audio(*audio, include_pyramid=pyramid)
+    else:
+        result = analyzer.analyze_audio_file(file_path, include_pyramid=pyramid)
     
     if "error" in result:
         print(f"Error: {result['error']}")
-        return
+        return None
     
     print(f"Duration: {result['duration']:.2f} seconds")
     print(f"Sample rate: {result['sample_rate']} Hz")
@@ -26,17 +60,27 @@ def test_audio_analysis(file_path):
     print(f"Beat count: {result['beats']['beat_count']}")
     
     # Create visualization
-    analyzer.plot_analysis(result, "analysis_visualization.png")
-    print("Analysis visualization saved to analysis_visualization.png")
+    if plot:
+        analyzer.plot_analysis(result, "analysis_visualization.png")
+        print("Analysis visualization saved to analysis_visualization.png")
+    
+    return result
 
-def test_mood_classification(file_path):
-    """Test mood classification on a single file."""
-    classifier = MoodClassifier()
+def test_mood_classification(file_path, classifier=None, audio=None):
+    """Test mood classification on a single file. Returns the result, or None on error.
+    
+    audio is an already decoded (samples, MOOD_SAMPLE_RATE) pair for file_path.
+    """
+    if classifier is None:
+        classifier = load_mood_classifier()
     
     print(f"Classifying mood for {file_path}...")
     try:
-        import librosa
-        audio_data, sr = librosa.load(file_path, sr=22050)
+        if audio is not None:
+            audio_data, sr = audio
+        else:
+            import librosa
+            audio_data, sr = librosa.load(file_path, sr=MOOD_SAMPLE_RATE)
         result = classifier.predict_mood(audio_data, sr)
         
         print(f"Predicted mood: {result['predicted_mood']}")
@@ -44,18 +88,88 @@ def test_mood_classification(file_path):
         print("\nProbabilities:")
         for mood, prob in result['probabilities'].items():
             print(f"  {mood}: {prob:.2f}")
+        return result
     except Exception as e:
         print(f"Error: {e}")
+        return None
 
-def start_server(port=5555):
-    """Start the analysis server."""
-    server = AnalysisServer(port)
+def save_analysis(output_path, result, mood=None):
+    """Write the binary analysis container (.mva) the C++ app loads."""
+    from src.python.analysis_format import write_analysis
+    
+    write_analysis(output_path, result, mood)
+    print(f"Analysis saved to {output_path}")
+
+def run_worker():
+    """Long-lived analysis worker for the C++ app.
+    
+    Pays for imports and JIT compilation once at launch, then serves one JSON
+    request per stdin line. Output uses the same text as the analyze/classify
+    commands, followed by an @@END line.
+    """
+    # Requests carry UTF-8 JSON; without this Windows decodes piped stdin in
+    # the locale code page and garbles non-ASCII track paths
+    sys.stdin.reconfigure(encoding="utf-8")
+    sys.stdout.reconfigure(encoding="utf-8")
+    
+    start = time.perf_counter()
+    import numpy as np
+    import librosa
+    from src.python.audio_analyzer import AudioAnalyzer
+    import_ms = (time.perf_counter() - start) * 1000.0
+    
+    analyzer = AudioAnalyzer()
+    classifier = load_mood_classifier()
+    
+    # Run the pipeline on a short click track so numba compiles (or loads
+    # from the cache) before the first real request arrives
+    warmup_start = time.perf_counter()
+    clicks = np.zeros(analyzer.sample_rate * 2, dtype=np.float32)
+    clicks[::analyzer.sample_rate // 2] = 1.0
+    analyzer.detect_beats(clicks)
+    analyzer.extract_features(clicks)
+    classifier.predict_mood(librosa.resample(clicks, orig_sr=analyzer.sample_rate, target_sr=MOOD_SAMPLE_RATE),
+                            MOOD_SAMPLE_RATE)
+    warmup_ms = (time.perf_counter() - warmup_start) * 1000.0
+    
+    print(f"@@READY import_ms={import_ms:.0f} warmup_ms={warmup_ms:.0f}", flush=True)
+    
+    for line in sys.stdin:
+        if not line.strip():
+            continue
+        try:
+            request = json.loads(line)
+            if request.get("command") == "analyze":
+                output_path = request.get("output")
+                audio, mood_audio = decode_audio(request["file"], analyzer)
+                if audio is None:
+                    raise ValueError("Failed to load audio file")
+                result = test_audio_analysis(request["file"], analyzer=analyzer, plot=False,
+                                             pyramid=output_path is not None, audio=audio)
+                mood = test_mood_classification(request["file"], classifier=classifier, audio=mood_audio)
+                if result and output_path:
+                    save_analysis(output_path, result, mood)
+            else:
+                print(f"Error: Unknown command: {request.get('command')}")
+        except Exception as e:
+            print(f"Error: {e}")
+        print("@@END", flush=True)
+
+def start_server(port=5555, workers=2, max_queue=16):
+    """Start the analysis server (broker plus worker pool, or a single process with workers=0)."""
+    if workers > 0:
+        from src.python.analysis_broker import AnalysisBroker
+        server = AnalysisBroker(port, num_workers=workers, max_batch_queue=max_queue)
+    else:
+        from src.python.analysis_server import AnalysisServer
+        server = AnalysisServer(port)
     
     try:
         print(f"Starting analysis server on port {port}...")
         server.start()
     except KeyboardInterrupt:
         print("\nShutting down server...")
+    finally:
         server.stop()
 
 def main():
@@ -65,6 +179,9 @@ def main():
     # Analyze command
     analyze_parser = subparsers.add_parser("analyze", help="Analyze an audio file")
     analyze_parser.add_argument("file", help="Audio file to analyze")
+    analyze_parser.add_argument("--output", help="Also write the full results to this binary analysis file (.mva)")
+    analyze_parser.add_argument("--classify", action="store_true",
+                                help="Also classify mood (included in --output)")
     
     # Classify command
     classify_parser = subparsers.add_parser("classify", help="Classify mood for an audio file")
@@ -73,15 +190,34 @@ def main():
     # Server command
     server_parser = subparsers.add_parser("server", help="Start the analysis server")
     server_parser.add_argument("--port", type=int, default=5555, help="Port to run server on")
+    server_parser.add_argument("--workers", type=int, default=2,
+                               help="Worker processes behind the broker (0 = single-process server)")
+    server_parser.add_argument("--max-queue", type=int, default=16,
+                               help="Maximum queued batch (analyze_file) requests before rejecting")
+    
+    # Worker command (used by the C++ app)
+    subparsers.add_parser("worker", help="Run a pre-warmed analysis worker reading requests from stdin")
     
     args = parser.parse_args()
     
     if args.command == "analyze":
-        test_audio_analysis(args.file)
+        if args.classify:
+            from src.python.audio_analyzer import AudioAnalyzer
+            analyzer = AudioAnalyzer()
+            audio, mood_audio = decode_audio(args.file, analyzer)
+            result = test_audio_analysis(args.file, analyzer=analyzer, pyramid=args.output is not None, audio=audio)
+            mood = test_mood_classification(args.file, audio=mood_audio) if audio else None
+        else:
+            result = test_audio_analysis(args.file, pyramid=args.output is not None)
+            mood = None
+        if result and args.output:
+            save_analysis(args.output, result, mood)
     elif args.command == "classify":
         test_mood_classification(args.file)
     elif args.command == "server":
-        start_server(args.port)
+        start_server(args.port, args.workers, args.max_queue)
+    elif args.command == "worker":
+        run_worker()
     else:
         parser.print_help()
 
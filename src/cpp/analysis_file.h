@@ -0,0 +1,493 @@
+#ifndef ANALYSIS_FILE_H
+#define ANALYSIS_FILE_H
+
+#include "feature_timeline.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Read-only view of a .mva analysis container written by
+// src/python/analysis_format.py (see there for the layout and versioning
+// rules). The file is memory-mapped and section arrays are used in place:
+// open() checks the header and the bounds of every section but never walks
+// the data, so opening costs the same for a short clip as for a long mix
+// and pages are only read when a section is actually used. write() stores a
+// FeatureTimeline in the same layout.
+class AnalysisFile {
+public:
+    static constexpr uint16_t kVersionMajor = 1;
+
+    enum SectionKind : uint32_t {
+        kEvents = 1,            // f32 sorted times in seconds (beats, bars, onsets)
+        kSeries = 2,            // f32 values at rate per second from startTime
+        kWaveformLevel = 3,     // f32 min/max pairs per bin; param = samples per bin
+        kMoodProbabilities = 4, // f32 per mood, in kMoodNames order
+        kMoodNames = 5,         // u8 NUL-terminated UTF-8 names
+        kVector = 6             // f32 values without a time axis (chroma_mean)
+    };
+
+    enum DataType : uint32_t {
+        kFloat32 = 1,
+        kUInt8 = 2
+    };
+
+    // On-disk records, little-endian
+    struct FileHeader {
+        char magic[4];            // "MVAF"
+        uint16_t versionMajor;    // Incompatible layout changes
+        uint16_t versionMinor;    // Backward-compatible additions
+        uint32_t headerSize;
+        uint32_t sectionCount;
+        uint64_t sectionTableOffset;
+        uint64_t fileSize;
+        double duration;          // Seconds
+        uint32_t sampleRate;
+        float tempo;              // BPM
+        int32_t moodIndex;        // Predicted mood in the kMoodNames list, -1 if unclassified
+        float moodConfidence;
+        uint32_t reserved[2];
+    };
+
+    struct SectionEntry {
+        uint32_t kind;
+        uint32_t dataType;
+        uint64_t offset;          // From the start of the file
+        uint64_t count;           // Elements of dataType
+        float rate;               // kSeries: values per second; kWaveformLevel: bins per second
+        float startTime;
+        uint32_t param;
+        uint32_t reserved;
+        char name[24];            // NUL-padded
+    };
+
+    static_assert(sizeof(FileHeader) == 64, "FileHeader must match the on-disk layout");
+    static_assert(sizeof(SectionEntry) == 64, "SectionEntry must match the on-disk layout");
+
+    template <typename T>
+    struct Span {
+        const T* first = nullptr;
+        size_t count = 0;
+
+        const T* begin() const { return first; }
+        const T* end() const { return first + count; }
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        const T& operator[](size_t i) const { return first[i]; }
+    };
+
+    struct Series {
+        Span<float> values;
+        float rate = 0.0f;
+        float startTime = 0.0f;
+    };
+
+    struct WaveformLevel {
+        Span<float> minMax;          // Interleaved min, max per bin
+        uint32_t samplesPerBin = 0;
+        float binsPerSecond = 0.0f;
+
+        size_t bins() const { return minMax.size() / 2; }
+    };
+
+    AnalysisFile() = default;
+    ~AnalysisFile() { close(); }
+
+    AnalysisFile(const AnalysisFile&) = delete;
+    AnalysisFile& operator=(const AnalysisFile&) = delete;
+
+    // path is UTF-8. On failure the file is left closed and error (if given)
+    // says why.
+    bool open(const std::string& path, std::string* error = nullptr) {
+        close();
+
+        const uint16_t probe = 1;
+        if (*reinterpret_cast<const unsigned char*>(&probe) != 1) {
+            return fail(error, "Analysis files are little-endian; this host is not");
+        }
+        if (!map(path)) {
+            return fail(error, "Cannot map analysis file");
+        }
+
+        if (size_ < sizeof(FileHeader)) {
+            return fail(error, "Too small for an analysis file");
+        }
+        const FileHeader& h = header();
+        if (std::memcmp(h.magic, "MVAF", 4) != 0) {
+            return fail(error, "Not an analysis file");
+        }
+        if (h.versionMajor != kVersionMajor) {
+            return fail(error, "Unsupported analysis file version");
+        }
+        if (h.fileSize != size_ || h.headerSize < sizeof(FileHeader) ||
+            h.sectionTableOffset % alignof(SectionEntry) != 0 ||
+            h.sectionTableOffset > size_ ||
+            h.sectionCount > (size_ - h.sectionTableOffset) / sizeof(SectionEntry)) {
+            return fail(error, "Truncated or corrupt analysis file");
+        }
+
+        sections_ = reinterpret_cast<const SectionEntry*>(data_ + h.sectionTableOffset);
+        for (uint32_t i = 0; i < h.sectionCount; ++i) {
+            const SectionEntry& s = sections_[i];
+            size_t element = elementSize(s.dataType);
+            if (element == 0) {
+                continue; // Newer data type; the section is skipped
+            }
+            if (s.offset % element != 0 || s.offset > size_ || s.count > (size_ - s.offset) / element) {
+                return fail(error, "Analysis file section out of bounds");
+            }
+            if (s.kind == kWaveformLevel && s.dataType == kFloat32) {
+                waveformLevels_.push_back(i);
+            }
+        }
+
+        std::sort(waveformLevels_.begin(), waveformLevels_.end(), [this](uint32_t a, uint32_t b) {
+            return sections_[a].param < sections_[b].param;
+        });
+        return true;
+    }
+
+    void close() {
+#ifdef _WIN32
+        if (data_) UnmapViewOfFile(data_);
+        if (mapping_) CloseHandle(mapping_);
+        if (file_ != INVALID_HANDLE_VALUE) CloseHandle(file_);
+        mapping_ = nullptr;
+        file_ = INVALID_HANDLE_VALUE;
+#else
+        if (data_) munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+        data_ = nullptr;
+        size_ = 0;
+        sections_ = nullptr;
+        waveformLevels_.clear();
+    }
+
+    bool isOpen() const { return sections_ != nullptr; }
+
+    // Header fields; only valid while open
+    const FileHeader& header() const { return *reinterpret_cast<const FileHeader*>(data_); }
+    double duration() const { return header().duration; }
+    uint32_t sampleRate() const { return header().sampleRate; }
+    float tempo() const { return header().tempo; }
+
+    Span<float> events(const char* name) const {
+        return floats(find(kEvents, name));
+    }
+
+    Series series(const char* name) const {
+        Series series;
+        if (const SectionEntry* s = find(kSeries, name)) {
+            series.values = floats(s);
+            series.rate = s->rate;
+            series.startTime = s->startTime;
+        }
+        return series;
+    }
+
+    Span<float> vector(const char* name) const {
+        return floats(find(kVector, name));
+    }
+
+    // Waveform envelope levels, 0 being the finest
+    int waveformLevelCount() const { return (int)waveformLevels_.size(); }
+
+    WaveformLevel waveformLevel(int level) const {
+        WaveformLevel result;
+        if (level >= 0 && level < (int)waveformLevels_.size()) {
+            const SectionEntry& s = sections_[waveformLevels_[level]];
+            result.minMax = floats(&s);
+            result.samplesPerBin = s.param;
+            result.binsPerSecond = s.rate;
+        }
+        return result;
+    }
+
+    // Coarsest level that still has at least one bin per pixel, or -1
+    int waveformLevelFor(double secondsPerPixel) const {
+        int best = waveformLevels_.empty() ? -1 : 0;
+        for (int i = 1; i < (int)waveformLevels_.size(); ++i) {
+            if (sections_[waveformLevels_[i]].rate * secondsPerPixel >= 1.0) {
+                best = i;
+            }
+        }
+        return best;
+    }
+
+    std::vector<std::string> moodNames() const {
+        std::vector<std::string> names;
+        const SectionEntry* s = find(kMoodNames, nullptr);
+        if (!s || s->dataType != kUInt8) {
+            return names;
+        }
+
+        const char* text = reinterpret_cast<const char*>(data_ + s->offset);
+        const char* end = text + s->count;
+        while (text < end) {
+            const char* terminator = std::find(text, end, '\0');
+            names.emplace_back(text, terminator);
+            text = terminator + 1;
+        }
+        return names;
+    }
+
+    // Same order as moodNames()
+    Span<float> moodProbabilities() const {
+        return floats(find(kMoodProbabilities, nullptr));
+    }
+
+    // Empty if the track was not classified
+    std::string predictedMood() const {
+        if (!isOpen()) {
+            return std::string();
+        }
+        std::vector<std::string> names = moodNames();
+        int index = header().moodIndex;
+        return (index >= 0 && index < (int)names.size()) ? names[index] : std::string();
+    }
+
+    float moodConfidence() const { return header().moodConfidence; }
+
+    // Writes a timeline's series and events as an analysis file that open()
+    // and toTimeline() read back, e.g. one built from a JSON reply. tempo
+    // goes in the header; the file has no mood or waveform levels. Written
+    // next to path and renamed into place, like the Python writer.
+    static bool write(const std::string& path, const FeatureTimeline& timeline, float tempo = 0.0f,
+                      std::string* error = nullptr) {
+        for (int id = 0; id < timeline.seriesCount() + timeline.eventsCount(); ++id) {
+            const std::string& name = id < timeline.seriesCount() ? timeline.seriesName(id)
+                                                                  : timeline.eventsName(id - timeline.seriesCount());
+            if (name.size() > sizeof(SectionEntry::name)) {
+                return writeFailed(error, "Section name too long");
+            }
+        }
+
+        struct Pending {
+            SectionEntry entry;
+            const std::vector<float>* values;
+        };
+        std::vector<Pending> pending;
+
+        for (int id = 0; id < timeline.seriesCount(); ++id) {
+            pending.push_back({ entry(kSeries, timeline.seriesName(id), timeline.seriesValues(id).size(),
+                                      timeline.frameRate(id), timeline.startTime(id)),
+                                &timeline.seriesValues(id) });
+        }
+        for (int id = 0; id < timeline.eventsCount(); ++id) {
+            pending.push_back({ entry(kEvents, timeline.eventsName(id), timeline.eventTimes(id).size(), 0.0f, 0.0f),
+                                &timeline.eventTimes(id) });
+        }
+
+        uint64_t offset = align(sizeof(FileHeader) + sizeof(SectionEntry) * pending.size());
+        for (Pending& p : pending) {
+            p.entry.offset = offset;
+            offset = align(offset + p.entry.count * sizeof(float));
+        }
+
+        FileHeader header = {};
+        std::memcpy(header.magic, "MVAF", 4);
+        header.versionMajor = kVersionMajor;
+        header.versionMinor = 0;
+        header.headerSize = sizeof(FileHeader);
+        header.sectionCount = (uint32_t)pending.size();
+        header.sectionTableOffset = sizeof(FileHeader);
+        header.fileSize = offset;
+        header.duration = timeline.duration();
+        header.tempo = tempo;
+        header.moodIndex = -1;
+
+        std::vector<char> bytes(offset, '\0');
+        std::memcpy(bytes.data(), &header, sizeof(header));
+        for (size_t i = 0; i < pending.size(); ++i) {
+            const Pending& p = pending[i];
+            std::memcpy(bytes.data() + sizeof(FileHeader) + i * sizeof(SectionEntry), &p.entry, sizeof(SectionEntry));
+            if (!p.values->empty()) {
+                std::memcpy(bytes.data() + p.entry.offset, p.values->data(), p.values->size() * sizeof(float));
+            }
+        }
+
+        std::string tempPath = path + ".tmp";
+        {
+#ifdef _WIN32
+            std::ofstream out(widen(tempPath), std::ios::binary | std::ios::trunc);
+#else
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+#endif
+            if (!out.write(bytes.data(), (std::streamsize)bytes.size()) || !out.flush()) {
+                return writeFailed(error, "Cannot write analysis file");
+            }
+        }
+#ifdef _WIN32
+        bool renamed = MoveFileExW(widen(tempPath).c_str(), widen(path).c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+        bool renamed = std::rename(tempPath.c_str(), path.c_str()) == 0;
+#endif
+        if (!renamed) {
+#ifdef _WIN32
+            DeleteFileW(widen(tempPath).c_str());
+#else
+            std::remove(tempPath.c_str());
+#endif
+            return writeFailed(error, "Cannot replace analysis file");
+        }
+        return true;
+    }
+
+    // Copies the events and series into a timeline for per-frame lookups
+    FeatureTimeline toTimeline() const {
+        FeatureTimeline timeline;
+        if (!isOpen()) {
+            return timeline;
+        }
+        timeline.setDuration((float)duration());
+
+        for (uint32_t i = 0; i < header().sectionCount; ++i) {
+            const SectionEntry& s = sections_[i];
+            Span<float> values = floats(&s);
+            if (s.kind == kSeries) {
+                timeline.setSeries(sectionName(s), s.rate, std::vector<float>(values.begin(), values.end()), s.startTime);
+            } else if (s.kind == kEvents) {
+                timeline.setEvents(sectionName(s), std::vector<float>(values.begin(), values.end()));
+            }
+        }
+        return timeline;
+    }
+
+private:
+    const unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+    const SectionEntry* sections_ = nullptr;
+    std::vector<uint32_t> waveformLevels_; // Section indices, finest first
+#ifdef _WIN32
+    HANDLE file_ = INVALID_HANDLE_VALUE;
+    HANDLE mapping_ = nullptr;
+#endif
+
+    static size_t elementSize(uint32_t dataType) {
+        switch (dataType) {
+        case kFloat32: return sizeof(float);
+        case kUInt8: return 1;
+        default: return 0;
+        }
+    }
+
+    static std::string sectionName(const SectionEntry& s) {
+        return std::string(s.name, std::find(s.name, s.name + sizeof(s.name), '\0'));
+    }
+
+    // First section of a kind, optionally with a given name
+    const SectionEntry* find(uint32_t kind, const char* name) const {
+        for (uint32_t i = 0; isOpen() && i < header().sectionCount; ++i) {
+            const SectionEntry& s = sections_[i];
+            if (s.kind == kind && elementSize(s.dataType) != 0 &&
+                (!name || std::strncmp(s.name, name, sizeof(s.name)) == 0)) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    Span<float> floats(const SectionEntry* s) const {
+        Span<float> span;
+        if (s && s->dataType == kFloat32) {
+            span.first = reinterpret_cast<const float*>(data_ + s->offset);
+            span.count = s->count;
+        }
+        return span;
+    }
+
+    static uint64_t align(uint64_t offset) {
+        return (offset + 63) / 64 * 64;
+    }
+
+    static SectionEntry entry(uint32_t kind, const std::string& name, size_t count, float rate, float startTime) {
+        SectionEntry s = {};
+        s.kind = kind;
+        s.dataType = kFloat32;
+        s.count = count;
+        s.rate = rate;
+        s.startTime = startTime;
+        std::memcpy(s.name, name.data(), std::min(name.size(), sizeof(s.name)));
+        return s;
+    }
+
+    static bool writeFailed(std::string* error, const char* message) {
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+
+    bool fail(std::string* error, const char* message) {
+        close();
+        if (error) {
+            *error = message;
+        }
+        return false;
+    }
+
+#ifdef _WIN32
+    static std::wstring widen(const std::string& path) {
+        int length = MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, nullptr, 0);
+        std::wstring widePath(length > 0 ? length : 1, L'\0');
+        MultiByteToWideChar(CP_UTF8, 0, path.c_str(), -1, &widePath[0], length);
+        widePath.resize(length > 0 ? length - 1 : 0);
+        return widePath;
+    }
+#endif
+
+    bool map(const std::string& path) {
+#ifdef _WIN32
+        std::wstring widePath = widen(path);
+
+        file_ = CreateFileW(widePath.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        LARGE_INTEGER fileSize;
+        if (file_ == INVALID_HANDLE_VALUE || !GetFileSizeEx(file_, &fileSize) || fileSize.QuadPart == 0) {
+            return false;
+        }
+        mapping_ = CreateFileMappingW(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!mapping_) {
+            return false;
+        }
+        data_ = static_cast<const unsigned char*>(MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, 0));
+        size_ = data_ ? (size_t)fileSize.QuadPart : 0;
+#else
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || info.st_size == 0) {
+            ::close(fd);
+            return false;
+        }
+        void* mapped = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd); // The mapping keeps the file referenced
+        if (mapped == MAP_FAILED) {
+            return false;
+        }
+        data_ = static_cast<const unsigned char*>(mapped);
+        size_ = (size_t)info.st_size;
+#endif
+        return data_ != nullptr;
+    }
+};
+
+#endif // ANALYSIS_FILE_H
@@ -5,12 +5,15 @@
 #include <string>
 #include <vector>
 #include <nlohmann/json.hpp>
+#include "feature_timeline.h"
+#include "analysis_file.h"
 
 using json = nlohmann::json;
 
 struct AnalysisResult {
     bool success;
     std::string error_message;
+    bool server_busy = false; // Rejected by broker backpressure; retry later
     float duration;
     int sample_rate;
     float tempo;
@@ -19,6 +22,7 @@ struct AnalysisResult {
     std::string predicted_mood;
     float mood_confidence;
     std::map<std::string, float> mood_probabilities;
+    FeatureTimeline timeline; // Time-indexed series and events for per-frame lookups
 };
 
 class AnalyzerClient {
@@ -33,15 +37,52 @@ public:
         context_.close();
     }
     
-    AnalysisResult analyzeFile(const std::string& file_path) {
+    // With write_file the server writes a binary analysis file in its own
+    // analyses directory and the result is loaded from it instead of from a
+    // large JSON reply (the server must be on this machine)
+    AnalysisResult analyzeFile(const std::string& file_path, bool write_file = false) {
         json request = {
             {"command", "analyze_file"},
             {"file_path", file_path}
         };
+        if (write_file) {
+            request["write_file"] = true;
+        }
         
         return sendRequest(request);
     }
     
+    // Fills a result from a binary analysis file (.mva), e.g. one cached from
+    // an earlier analyzeFile() call
+    static bool loadAnalysisFile(const std::string& path, AnalysisResult& result) {
+        AnalysisFile file;
+        if (!file.open(path, &result.error_message)) {
+            result.success = false;
+            return false;
+        }
+        
+        result.success = true;
+        result.duration = (float)file.duration();
+        result.sample_rate = (int)file.sampleRate();
+        result.tempo = file.tempo();
+        
+        AnalysisFile::Span<float> beats = file.events("beats");
+        result.beat_times.assign(beats.begin(), beats.end());
+        AnalysisFile::Span<float> waveform = file.series("waveform").values;
+        result.waveform.assign(waveform.begin(), waveform.end());
+        
+        result.predicted_mood = file.predictedMood();
+        result.mood_confidence = file.moodConfidence();
+        std::vector<std::string> moods = file.moodNames();
+        AnalysisFile::Span<float> probabilities = file.moodProbabilities();
+        for (size_t i = 0; i < moods.size() && i < probabilities.size(); ++i) {
+            result.mood_probabilities[moods[i]] = probabilities[i];
+        }
+        
+        result.timeline = file.toTimeline();
+        return true;
+    }
+    
     AnalysisResult analyzeChunk(const std::vector<float>& audio_data, int sample_rate) {
         json request = {
             {"command", "analyze_chunk"},
@@ -52,6 +93,24 @@ public:
         return sendRequest(request);
     }
     
+    // Queue depths, wait/service time metrics and worker health from the broker
+    json serverStats() {
+        try {
+            std::string request_str = json({{"command", "stats"}}).dump();
+            zmq::message_t zmq_request(request_str.size());
+            memcpy(zmq_request.data(), request_str.data(), request_str.size());
+            socket_.send(zmq_request, zmq::send_flags::none);
+            
+            zmq::message_t zmq_reply;
+            socket_.recv(zmq_reply, zmq::recv_flags::none);
+            
+            json response = json::parse(std::string(static_cast<char*>(zmq_reply.data()), zmq_reply.size()));
+            return response.value("data", json::object());
+        } catch (const std::exception&) {
+            return json::object();
+        }
+    }
+    
 private:
     zmq::context_t context_;
     zmq::socket_t socket_;
@@ -74,7 +133,11 @@ private:
             json response = json::parse(reply_str);
             
             // Parse response
-            if (response["status"] == "success") {
+            if (response["status"] == "success" && response["data"].contains("output_path")) {
+                if (!loadAnalysisFile(response["data"]["output_path"].get<std::string>(), result)) {
+                    result.error_message = "Cannot read analysis file: " + result.error_message;
+                }
+            } else if (response["status"] == "success") {
                 result.success = true;
                 auto data = response["data"];
                 
@@ -93,6 +156,8 @@ private:
                     result.waveform = data["waveform"].get<std::vector<float>>();
                 }
                 
+                buildTimeline(data, result);
+                
                 // Mood
                 if (data.contains("mood")) {
                     result.predicted_mood = data["mood"]["predicted_mood"];
@@ -102,6 +167,7 @@ private:
             } else {
                 result.success = false;
                 result.error_message = response.value("message", "Unknown error");
+                result.server_busy = response.value("busy", false);
             }
         } catch (const std::exception& e) {
             result.success = false;
@@ -110,6 +176,36 @@ private:
         
         return result;
     }
+    
+    void buildTimeline(const json& data, AnalysisResult& result) {
+        FeatureTimeline& timeline = result.timeline;
+        timeline.setDuration(result.duration);
+        
+        if (!result.waveform.empty()) {
+            timeline.setSeries("waveform", data.value("waveform_rate", 0.0f), result.waveform);
+        }
+        if (!result.beat_times.empty()) {
+            timeline.setEvents("beats", result.beat_times);
+        }
+        if (data.contains("beats") && data["beats"].contains("bar_times")) {
+            timeline.setEvents("bars", data["beats"]["bar_times"].get<std::vector<float>>());
+        }
+        
+        if (data.contains("features")) {
+            const json& features = data["features"];
+            float frame_rate = features.value("frame_rate", 0.0f);
+            
+            if (features.contains("rms_energy")) {
+                timeline.setSeries("rms", frame_rate, features["rms_energy"].get<std::vector<float>>());
+            }
+            if (features.contains("spectral_centroids")) {
+                timeline.setSeries("spectral_centroid", frame_rate, features["spectral_centroids"].get<std::vector<float>>());
+            }
+            if (features.contains("onset_times")) {
+                timeline.setEvents("onsets", features["onset_times"].get<std::vector<float>>());
+            }
+        }
+    }
 };
 
 #endif // ANALYZER_CLIENT_H
\ No newline at end of file
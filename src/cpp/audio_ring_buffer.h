@@ -0,0 +1,86 @@
+#ifndef AUDIO_RING_BUFFER_H
+#define AUDIO_RING_BUFFER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Lock-free single-producer/single-consumer ring of fixed-size mono blocks.
+//
+// The capture thread accumulates device samples into a block and publishes
+// it with push(); the render thread drains blocks with pop(). All storage is
+// allocated up front, so neither side allocates or locks. When the consumer
+// falls behind the newest block is dropped and counted in overruns().
+class AudioBlockRing {
+public:
+    struct Block {
+        std::vector<float> samples;
+        int64_t captureNs = 0; // Monotonic time the last sample was captured
+    };
+
+    // blockCount is rounded up to a power of two
+    AudioBlockRing(size_t blockCount, size_t blockFrames)
+        : blockFrames_(std::max<size_t>(1, blockFrames)) {
+        size_t capacity = 2;
+        while (capacity < blockCount) {
+            capacity <<= 1;
+        }
+        mask_ = capacity - 1;
+
+        blocks_.resize(capacity);
+        for (Block& block : blocks_) {
+            block.samples.assign(blockFrames_, 0.0f);
+        }
+    }
+
+    size_t blockFrames() const { return blockFrames_; }
+    size_t capacity() const { return blocks_.size(); }
+
+    // Producer side. samples must hold blockFrames() values.
+    bool push(const float* samples, int64_t captureNs) {
+        size_t head = head_.load(std::memory_order_relaxed);
+        if (head - tail_.load(std::memory_order_acquire) >= blocks_.size()) {
+            overruns_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        Block& block = blocks_[head & mask_];
+        std::copy(samples, samples + blockFrames_, block.samples.begin());
+        block.captureNs = captureNs;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Copies the oldest block into out (sized on first use).
+    bool pop(Block& out) {
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+
+        const Block& block = blocks_[tail & mask_];
+        out.samples.assign(block.samples.begin(), block.samples.end());
+        out.captureNs = block.captureNs;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t available() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+    }
+
+    uint64_t overruns() const { return overruns_.load(std::memory_order_relaxed); }
+
+private:
+    size_t blockFrames_;
+    size_t mask_;
+    std::vector<Block> blocks_;
+
+    // Producer and consumer indices on separate cache lines
+    alignas(64) std::atomic<size_t> head_{ 0 };
+    alignas(64) std::atomic<size_t> tail_{ 0 };
+    alignas(64) std::atomic<uint64_t> overruns_{ 0 };
+};
+
+#endif // AUDIO_RING_BUFFER_H
@@ -0,0 +1,174 @@
+#ifndef FEATURE_TIMELINE_H
+#define FEATURE_TIMELINE_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Time index over the analysis of one track. Continuous features (waveform,
+// RMS, spectral centroid, ...) are stored as fixed-rate series so a value at
+// any time is a direct array lookup; events (beats, onsets, bars) are sorted
+// time lists searched by binary search. Lookups are meant to run per frame
+// for playback, seek/scrub and export at arbitrary times.
+//
+// Look names up once with seriesId()/eventsId() and keep the ids; the
+// by-name overloads are a convenience for one-off queries. Timelines are
+// stored as analysis files (.mva): AnalysisFile::write() saves one and
+// AnalysisFile::toTimeline() loads it back.
+class FeatureTimeline {
+public:
+    struct EventRange {
+        const float* first = nullptr;
+        const float* last = nullptr;
+
+        const float* begin() const { return first; }
+        const float* end() const { return last; }
+        size_t size() const { return last - first; }
+        bool empty() const { return first == last; }
+    };
+
+    bool empty() const { return series_.empty() && events_.empty(); }
+
+    float duration() const { return duration_; }
+    void setDuration(float duration) { duration_ = duration; }
+
+    // Adds or replaces a series sampled at frameRate values per second,
+    // with values[0] at startTime
+    int setSeries(const std::string& name, float frameRate, std::vector<float> values, float startTime = 0.0f) {
+        Series series;
+        series.name = name;
+        series.frameRate = frameRate > 0.0f ? frameRate : 1.0f;
+        series.startTime = startTime;
+        series.values = std::move(values);
+        series.peak = 0.0f;
+        for (float v : series.values) {
+            series.peak = std::max(series.peak, std::fabs(v));
+        }
+
+        int id = seriesId(name);
+        if (id >= 0) {
+            series_[id] = std::move(series);
+            return id;
+        }
+        series_.push_back(std::move(series));
+        return (int)series_.size() - 1;
+    }
+
+    // Adds or replaces an event list; times are sorted on insert
+    int setEvents(const std::string& name, std::vector<float> times) {
+        std::sort(times.begin(), times.end());
+
+        int id = eventsId(name);
+        if (id >= 0) {
+            events_[id].times = std::move(times);
+            return id;
+        }
+        events_.push_back({ name, std::move(times) });
+        return (int)events_.size() - 1;
+    }
+
+    int seriesId(const std::string& name) const {
+        for (size_t i = 0; i < series_.size(); ++i) {
+            if (series_[i].name == name) return (int)i;
+        }
+        return -1;
+    }
+
+    int eventsId(const std::string& name) const {
+        for (size_t i = 0; i < events_.size(); ++i) {
+            if (events_[i].name == name) return (int)i;
+        }
+        return -1;
+    }
+
+    // Linearly interpolated value at time t, clamped to the series range. O(1).
+    float valueAt(int id, float t) const {
+        if (id < 0 || id >= (int)series_.size() || series_[id].values.empty()) {
+            return 0.0f;
+        }
+
+        const Series& series = series_[id];
+        float position = (t - series.startTime) * series.frameRate;
+        size_t lastIndex = series.values.size() - 1;
+        if (position <= 0.0f) return series.values.front();
+        if (position >= (float)lastIndex) return series.values.back();
+
+        size_t index = (size_t)position;
+        float fraction = position - index;
+        return series.values[index] + (series.values[index + 1] - series.values[index]) * fraction;
+    }
+
+    float valueAt(const std::string& name, float t) const {
+        return valueAt(seriesId(name), t);
+    }
+
+    // Largest absolute value of a series, for normalizing to [0, 1]
+    float peak(int id) const {
+        return (id >= 0 && id < (int)series_.size()) ? series_[id].peak : 0.0f;
+    }
+
+    // Events with t0 <= time < t1. O(log n).
+    EventRange eventsIn(int id, float t0, float t1) const {
+        EventRange range;
+        if (id < 0 || id >= (int)events_.size() || t1 <= t0) {
+            return range;
+        }
+
+        const std::vector<float>& times = events_[id].times;
+        auto first = std::lower_bound(times.begin(), times.end(), t0);
+        auto last = std::lower_bound(first, times.end(), t1);
+        range.first = times.data() + (first - times.begin());
+        range.last = times.data() + (last - times.begin());
+        return range;
+    }
+
+    EventRange eventsIn(const std::string& name, float t0, float t1) const {
+        return eventsIn(eventsId(name), t0, t1);
+    }
+
+    // Index of the last event at or before t, or -1. O(log n).
+    int eventIndexAt(int id, float t) const {
+        if (id < 0 || id >= (int)events_.size()) {
+            return -1;
+        }
+
+        const std::vector<float>& times = events_[id].times;
+        return (int)(std::upper_bound(times.begin(), times.end(), t) - times.begin()) - 1;
+    }
+
+    const std::vector<float>& eventTimes(int id) const {
+        static const std::vector<float> none;
+        return (id >= 0 && id < (int)events_.size()) ? events_[id].times : none;
+    }
+
+    // Iteration over everything stored, e.g. for writing it out; ids run
+    // from 0 to seriesCount() - 1 and eventsCount() - 1
+    int seriesCount() const { return (int)series_.size(); }
+    int eventsCount() const { return (int)events_.size(); }
+    const std::string& seriesName(int id) const { return series_[id].name; }
+    const std::string& eventsName(int id) const { return events_[id].name; }
+    float frameRate(int id) const { return series_[id].frameRate; }
+    float startTime(int id) const { return series_[id].startTime; }
+    const std::vector<float>& seriesValues(int id) const { return series_[id].values; }
+
+private:
+    struct Series {
+        std::string name;
+        float frameRate;
+        float startTime;
+        float peak;
+        std::vector<float> values;
+    };
+
+    struct EventList {
+        std::string name;
+        std::vector<float> times;
+    };
+
+    float duration_ = 0.0f;
+    std::vector<Series> series_;
+    std::vector<EventList> events_;
+};
+
+#endif // FEATURE_TIMELINE_H
@@ -0,0 +1,141 @@
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QImage>
+#include <QElapsedTimer>
+#include <iostream>
+#include <cmath>
+#include <cstring>
+
+#include "visualizer_scene.h"
+#include "software_renderer.h"
+#include "feature_timeline.h"
+#include "analysis_file.h"
+#include "quality_controller.h"
+
+// Headless entry point: renders the visualizer with the CPU rasterizer and
+// writes numbered PNG frames. Uses QCoreApplication only, so it runs without
+// a display server or GL driver (e.g. in containers for thumbnails/exports).
+int main(int argc, char *argv[]) {
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("MusicVisualizerHeadless");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Render AI Music Visualizer frames without a GPU");
+    parser.addHelpOption();
+    parser.addOptions({
+        { { "o", "output" }, "Directory for rendered PNG frames.", "dir", "frames" },
+        { "width", "Frame width in pixels.", "px", "800" },
+        { "height", "Frame height in pixels.", "px", "600" },
+        { "fps", "Output frames per second.", "fps", "30" },
+        { "duration", "Seconds of animation to render.", "seconds", "1" },
+        { "start", "Animation time of the first frame in seconds.", "seconds", "0" },
+        { "tempo", "Tempo in BPM driving the animation.", "bpm", "120" },
+        { "mood", "Mood color: happy, sad, energetic, calm or angry.", "mood", "" },
+        { "threads", "Rasterizer threads (0 = all cores).", "count", "0" },
+        { "quality", "Visual quality level 0-4 (2 matches the app default).", "level", "2" },
+        { "analysis", "Analysis file (.mva) from the app's cache; drives beats and energy, and sets tempo and mood unless given.", "file" },
+    });
+    parser.process(app);
+
+    int width = parser.value("width").toInt();
+    int height = parser.value("height").toInt();
+    double fps = parser.value("fps").toDouble();
+    double duration = parser.value("duration").toDouble();
+    double start = parser.value("start").toDouble();
+    int threads = parser.value("threads").toInt();
+
+    if (width <= 0 || height <= 0 || fps <= 0.0 || duration < 0.0 || start < 0.0) {
+        std::cerr << "Invalid frame size, fps, start or duration" << std::endl;
+        return 1;
+    }
+
+    VisualizerSceneState state;
+    state.quality = AdaptiveQualityController::qualityForLevel(parser.value("quality").toInt());
+    state.tempo = parser.value("tempo").toFloat();
+    if (state.tempo <= 0.0f) {
+        state.tempo = 120.0f;
+    }
+
+    QString mood = parser.value("mood");
+    if (!mood.isEmpty() && !visualizerMoodColor(mood.toStdString(), state.moodR, state.moodG, state.moodB)) {
+        std::cerr << "Unknown mood: " << mood.toStdString() << std::endl;
+        return 1;
+    }
+
+    QDir outputDir(parser.value("output"));
+    if (!outputDir.mkpath(".")) {
+        std::cerr << "Cannot create output directory: " << outputDir.path().toStdString() << std::endl;
+        return 1;
+    }
+
+    FeatureTimeline timeline;
+    if (parser.isSet("analysis")) {
+        AnalysisFile analysis;
+        std::string error;
+        if (!analysis.open(parser.value("analysis").toStdString(), &error)) {
+            std::cerr << "Cannot read analysis: " << parser.value("analysis").toStdString() << ": " << error << std::endl;
+            return 1;
+        }
+        timeline = analysis.toTimeline();
+        if (!parser.isSet("tempo") && analysis.tempo() > 0.0f) {
+            state.tempo = analysis.tempo();
+        }
+        if (mood.isEmpty()) {
+            visualizerMoodColor(analysis.predictedMood(), state.moodR, state.moodG, state.moodB);
+        }
+    }
+    int beatsId = timeline.eventsId("beats");
+    int rmsId = timeline.seriesId("rms");
+
+    SoftwareRenderer renderer(width, height, threads);
+    QImage image(width, height, QImage::Format_RGBA8888);
+
+    // Beat state advances in the same 16 ms ticks as the on-screen timer, so
+    // the output matches the live view independent of the export frame rate.
+    const double tickSeconds = 0.016;
+    double simulatedTime = 0.0;
+    state.beatIntensity = 1.0f;
+
+    int frameCount = std::max(1, (int)std::lround(duration * fps));
+    QElapsedTimer renderTimer;
+    renderTimer.start();
+
+    for (int frame = 0; frame < frameCount; ++frame) {
+        double frameTime = start + frame / fps;
+        while (simulatedTime + tickSeconds <= frameTime) {
+            float tickStart = (float)simulatedTime;
+            simulatedTime += tickSeconds;
+            state.time = (float)simulatedTime;
+            if (beatsId >= 0) {
+                stepVisualizerBeat(state, !timeline.eventsIn(beatsId, tickStart, state.time).empty());
+            } else {
+                stepVisualizerBeat(state);
+            }
+        }
+        state.time = (float)frameTime;
+        if (rmsId >= 0 && timeline.peak(rmsId) > 0.0f) {
+            state.energy = 0.5f + 0.5f * timeline.valueAt(rmsId, state.time) / timeline.peak(rmsId);
+        }
+
+        renderer.beginFrame(visualizerBackground(state));
+        drawVisualizerScene(state, renderer);
+        renderer.endFrame();
+
+        for (int y = 0; y < height; ++y) {
+            memcpy(image.scanLine(y), renderer.pixels() + (size_t)y * width * 4, (size_t)width * 4);
+        }
+
+        QString fileName = outputDir.filePath(QString("frame_%1.png").arg(frame, 5, 10, QChar('0')));
+        if (!image.save(fileName)) {
+            std::cerr << "Failed to write " << fileName.toStdString() << std::endl;
+            return 1;
+        }
+    }
+
+    qint64 elapsed = renderTimer.elapsed();
+    std::cout << "Rendered " << frameCount << " frames (" << width << "x" << height << ") to "
+              << outputDir.absolutePath().toStdString() << " in " << elapsed << " ms" << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,261 @@
+#ifndef LIVE_AUDIO_ANALYZER_H
+#define LIVE_AUDIO_ANALYZER_H
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <string>
+#include <vector>
+
+// Real-time counterpart of the Python analysis for live input. Processes
+// one small capture block at a time with bounded work and no allocation:
+//   - spectrum: Hann-windowed FFT over the latest fftSize samples, folded
+//     into log-spaced bands for the frequency bars
+//   - onsets: spectral flux against an adaptive threshold, which also
+//     yields a tempo estimate from recent onset intervals
+//   - mood: slow loudness/brightness averages mapped onto the five moods,
+//     a coarse stand-in for the classifier that needs whole tracks
+class LiveAudioAnalyzer {
+public:
+    LiveAudioAnalyzer(int sampleRate = 44100, int fftSize = 1024, int numBands = 32)
+        : fftSize_(fftSize), history_(fftSize, 0.0f), window_(fftSize), fft_(fftSize),
+          magnitudes_(fftSize / 2, 0.0f), previousMagnitudes_(fftSize / 2, 0.0f),
+          bands_(numBands, 0.0f), fluxHistory_(kFluxHistory, 0.0f) {
+        for (int i = 0; i < fftSize_; ++i) {
+            window_[i] = 0.5f - 0.5f * std::cos(2.0f * (float)M_PI * i / (fftSize_ - 1));
+        }
+        setSampleRate(sampleRate);
+    }
+
+    void setSampleRate(int sampleRate) {
+        sampleRate_ = sampleRate > 0 ? sampleRate : 44100;
+
+        // Log-spaced band edges between 40 Hz and 16 kHz (or Nyquist)
+        int bins = fftSize_ / 2;
+        float lowHz = 40.0f;
+        float highHz = std::min(16000.0f, sampleRate_ * 0.5f);
+        bandEdges_.assign(bands_.size() + 1, 0);
+        for (size_t i = 0; i <= bands_.size(); ++i) {
+            float hz = lowHz * std::pow(highHz / lowHz, (float)i / bands_.size());
+            bandEdges_[i] = std::clamp((int)(hz * fftSize_ / sampleRate_), 1, bins);
+        }
+    }
+
+    // Feeds one block; returns true if it contains an onset
+    bool processBlock(const float* samples, size_t count) {
+        float sumSquares = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            history_[historyPos_] = samples[i];
+            historyPos_ = (historyPos_ + 1) % fftSize_;
+            sumSquares += samples[i] * samples[i];
+        }
+        seconds_ += (float)count / sampleRate_;
+
+        updateEnergy(count > 0 ? std::sqrt(sumSquares / count) : 0.0f, count);
+        computeSpectrum();
+        updateBands(count);
+        bool onset = detectOnset();
+        if (!silent_) {
+            updateMood(count);
+        }
+        return onset;
+    }
+
+    const std::vector<float>& bands() const { return bands_; } // 0..1 per band
+    float energy() const { return energy_; }                   // 0..1 loudness, 0 when silent
+    bool silent() const { return silent_; }                    // Input below kSilenceRms
+    float centroidHz() const { return centroidHz_; }
+    float tempo() const { return tempo_; }                     // BPM, 0 until known
+    const std::string& mood() const { return mood_; }          // Empty until stable
+
+private:
+    static constexpr int kFluxHistory = 64;        // ~370 ms at 256-frame blocks
+    static constexpr float kOnsetRatio = 1.6f;     // Flux above mean by this factor
+    static constexpr float kRefractorySeconds = 0.1f;
+    static constexpr float kMoodHoldSeconds = 2.0f;
+    static constexpr float kSilenceRms = 0.00316f; // -50 dBFS; idle inputs and hiss stay below
+
+    int fftSize_;
+    int sampleRate_ = 44100;
+    std::vector<float> history_;
+    int historyPos_ = 0;
+    std::vector<float> window_;
+    std::vector<std::complex<float>> fft_;
+    std::vector<float> magnitudes_;
+    std::vector<float> previousMagnitudes_;
+    std::vector<float> bands_;
+    std::vector<int> bandEdges_;
+    std::vector<float> fluxHistory_;
+    int fluxPos_ = 0;
+
+    float seconds_ = 0.0f;      // Audio time processed so far
+    float energy_ = 0.0f;
+    float peakRms_ = kSilenceRms;
+    bool silent_ = true;
+    float centroidHz_ = 0.0f;
+    float lastOnset_ = -1.0f;
+    float intervals_[8] = {};
+    int intervalCount_ = 0;
+    float tempo_ = 0.0f;
+
+    float slowEnergy_ = 0.0f;
+    float slowCentroid_ = 0.0f;
+    std::string mood_;
+    std::string candidateMood_;
+    float candidateSince_ = 0.0f;
+
+    // Exponential smoothing coefficient for a time constant at this block size
+    float smoothing(size_t count, float timeConstant) const {
+        return 1.0f - std::exp(-(float)count / (sampleRate_ * timeConstant));
+    }
+
+    void updateEnergy(float rms, size_t count) {
+        // Normalize against a slowly decaying peak so quiet inputs still move,
+        // but never boost an idle input up to full loudness
+        peakRms_ = std::max(rms, peakRms_ * (1.0f - smoothing(count, 10.0f)));
+        peakRms_ = std::max(peakRms_, kSilenceRms);
+        silent_ = rms < kSilenceRms;
+        energy_ = silent_ ? 0.0f : std::clamp(rms / peakRms_, 0.0f, 1.0f);
+    }
+
+    void computeSpectrum() {
+        // Unroll the circular history, oldest sample first
+        for (int i = 0; i < fftSize_; ++i) {
+            fft_[i] = std::complex<float>(history_[(historyPos_ + i) % fftSize_] * window_[i], 0.0f);
+        }
+        transform(fft_);
+
+        float weighted = 0.0f, total = 0.0f;
+        for (size_t k = 0; k < magnitudes_.size(); ++k) {
+            magnitudes_[k] = std::abs(fft_[k]);
+            weighted += magnitudes_[k] * k;
+            total += magnitudes_[k];
+        }
+        centroidHz_ = total > 0.0f ? weighted / total * sampleRate_ / fftSize_ : 0.0f;
+    }
+
+    // In-place iterative radix-2 FFT; size must be a power of two
+    static void transform(std::vector<std::complex<float>>& data) {
+        size_t n = data.size();
+        for (size_t i = 1, j = 0; i < n; ++i) {
+            size_t bit = n >> 1;
+            for (; j & bit; bit >>= 1) {
+                j ^= bit;
+            }
+            j ^= bit;
+            if (i < j) {
+                std::swap(data[i], data[j]);
+            }
+        }
+
+        for (size_t length = 2; length <= n; length <<= 1) {
+            float angle = -2.0f * (float)M_PI / length;
+            std::complex<float> step(std::cos(angle), std::sin(angle));
+            for (size_t i = 0; i < n; i += length) {
+                std::complex<float> w(1.0f, 0.0f);
+                for (size_t k = 0; k < length / 2; ++k) {
+                    std::complex<float> even = data[i + k];
+                    std::complex<float> odd = data[i + k + length / 2] * w;
+                    data[i + k] = even + odd;
+                    data[i + k + length / 2] = even - odd;
+                    w *= step;
+                }
+            }
+        }
+    }
+
+    void updateBands(size_t count) {
+        float attack = smoothing(count, 0.01f);
+        float release = smoothing(count, 0.25f);
+
+        for (size_t b = 0; b < bands_.size(); ++b) {
+            int first = bandEdges_[b];
+            int last = std::max(first + 1, bandEdges_[b + 1]);
+            float sum = 0.0f;
+            for (int k = first; k < last && k < (int)magnitudes_.size(); ++k) {
+                sum += magnitudes_[k];
+            }
+
+            // Map -60..0 dB (relative to a full-scale windowed sine) to 0..1
+            float magnitude = sum / (last - first) / (fftSize_ * 0.25f);
+            float db = 20.0f * std::log10(magnitude + 1e-9f);
+            float level = std::clamp((db + 60.0f) / 60.0f, 0.0f, 1.0f);
+
+            float rate = level > bands_[b] ? attack : release;
+            bands_[b] += (level - bands_[b]) * rate;
+        }
+    }
+
+    bool detectOnset() {
+        float flux = 0.0f;
+        for (size_t k = 0; k < magnitudes_.size(); ++k) {
+            flux += std::max(0.0f, magnitudes_[k] - previousMagnitudes_[k]);
+        }
+        previousMagnitudes_.swap(magnitudes_);
+
+        float mean = 0.0f;
+        for (float f : fluxHistory_) {
+            mean += f;
+        }
+        mean /= kFluxHistory;
+        fluxHistory_[fluxPos_] = flux;
+        fluxPos_ = (fluxPos_ + 1) % kFluxHistory;
+
+        if (silent_ || flux <= mean * kOnsetRatio || flux < 1e-3f || energy_ < 0.05f) {
+            return false;
+        }
+        if (lastOnset_ >= 0.0f && seconds_ - lastOnset_ < kRefractorySeconds) {
+            return false;
+        }
+
+        if (lastOnset_ >= 0.0f) {
+            float interval = seconds_ - lastOnset_;
+            if (interval >= 0.25f && interval <= 1.5f) {
+                intervals_[intervalCount_ % 8] = interval;
+                ++intervalCount_;
+                updateTempo();
+            }
+        }
+        lastOnset_ = seconds_;
+        return true;
+    }
+
+    void updateTempo() {
+        int n = std::min(intervalCount_, 8);
+        if (n < 4) {
+            return;
+        }
+
+        float sorted[8];
+        std::copy(intervals_, intervals_ + n, sorted);
+        std::sort(sorted, sorted + n);
+        float bpm = 60.0f / sorted[n / 2];
+
+        // Fold into the range the animation is tuned for
+        while (bpm < 70.0f) bpm *= 2.0f;
+        while (bpm > 180.0f) bpm *= 0.5f;
+        tempo_ = bpm;
+    }
+
+    void updateMood(size_t count) {
+        float rate = smoothing(count, 3.0f);
+        slowEnergy_ += (energy_ - slowEnergy_) * rate;
+        slowCentroid_ += (centroidHz_ - slowCentroid_) * rate;
+
+        std::string mood;
+        bool bright = slowCentroid_ > 2500.0f;
+        if (slowEnergy_ > 0.6f) mood = bright ? "angry" : "energetic";
+        else if (slowEnergy_ > 0.35f) mood = bright ? "happy" : "energetic";
+        else mood = bright ? "calm" : "sad";
+
+        // Only switch after the new mood has held for a while
+        if (mood != candidateMood_) {
+            candidateMood_ = mood;
+            candidateSince_ = seconds_;
+        } else if (mood != mood_ && seconds_ - candidateSince_ >= kMoodHoldSeconds) {
+            mood_ = mood;
+        }
+    }
+};
+
+#endif // LIVE_AUDIO_ANALYZER_H
@@ -0,0 +1,421 @@
+#ifndef LIVE_AUDIO_INPUT_H
+#define LIVE_AUDIO_INPUT_H
+
+#include <QObject>
+#include <QThread>
+#include <QTimer>
+#include <QFile>
+#include <QElapsedTimer>
+#include <QAudioSource>
+#include <QAudioFormat>
+#include <QAudioDevice>
+#include <QMediaDevices>
+#include <QDebug>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "audio_ring_buffer.h"
+#include "live_audio_analyzer.h"
+
+// Live capture pipeline:
+//
+//   capture thread: device -> LiveAudioCapture (fixed blocks) -> AudioBlockRing
+//   GUI thread:     AudioBlockRing -> LiveAudioAnalyzer -> visualizer frame
+//
+// Blocks carry the monotonic time their last sample was captured, so the
+// visualizer can report input-to-photon latency once the frame using them
+// has been swapped to the screen.
+
+inline int64_t monotonicNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Base for capture sources; runs on the capture thread
+class LiveAudioCapture : public QObject {
+    Q_OBJECT
+
+public:
+    LiveAudioCapture(AudioBlockRing& ring) : ring(ring), block(ring.blockFrames()) {}
+
+    int sampleRate() const { return rate.load(); }
+
+    // Device-side buffering not visible in our timestamps, in ms
+    double deviceLatencyMs() const { return deviceLatency.load(); }
+
+public slots:
+    virtual void start() = 0;
+    virtual void stop() = 0;
+
+signals:
+    void failed(const QString& message);
+
+protected:
+    std::atomic<int> rate{ 0 };
+    std::atomic<double> deviceLatency{ 0.0 };
+
+    // Slices mono samples into fixed blocks. endNs is the capture time of
+    // the last sample in this chunk; earlier blocks are back-dated.
+    void deliver(const float* samples, int frames, int64_t endNs) {
+        int sr = rate.load();
+        for (int i = 0; i < frames; ++i) {
+            block[filled++] = samples[i];
+            if (filled == block.size()) {
+                int64_t captureNs = endNs - (int64_t)(frames - 1 - i) * 1000000000LL / sr;
+                ring.push(block.data(), captureNs);
+                filled = 0;
+            }
+        }
+    }
+
+private:
+    AudioBlockRing& ring;
+    std::vector<float> block;
+    size_t filled = 0;
+};
+
+// Audio input device (line-in, microphone or a loopback device)
+class DeviceAudioCapture : public LiveAudioCapture {
+    Q_OBJECT
+
+public:
+    DeviceAudioCapture(AudioBlockRing& ring, const QAudioDevice& device)
+        : LiveAudioCapture(ring), device(device) {}
+
+public slots:
+    void start() override {
+        if (device.isNull()) {
+            emit failed("No audio input device available");
+            return;
+        }
+
+        QAudioFormat wanted;
+        wanted.setSampleRate(44100);
+        wanted.setChannelCount(1);
+        wanted.setSampleFormat(QAudioFormat::Float);
+        format = device.isFormatSupported(wanted) ? wanted : device.preferredFormat();
+        rate = format.sampleRate();
+
+        source = new QAudioSource(device, format, this);
+        // ~10 ms of device buffering keeps input latency low
+        source->setBufferSize(format.bytesForDuration(10000));
+        io = source->start();
+        if (!io) {
+            emit failed("Could not open audio input: " + device.description());
+            return;
+        }
+
+        deviceLatency = format.durationForBytes(source->bufferSize()) / 2000.0;
+        connect(io, &QIODevice::readyRead, this, &DeviceAudioCapture::readAvailable);
+        qDebug() << "Capturing from" << device.description() << format;
+    }
+
+    void stop() override {
+        if (source) {
+            source->stop();
+            delete source;
+            source = nullptr;
+            io = nullptr;
+        }
+    }
+
+private:
+    QAudioDevice device;
+    QAudioFormat format;
+    QAudioSource* source = nullptr;
+    QIODevice* io = nullptr;
+    std::vector<float> mono;
+
+    void readAvailable() {
+        QByteArray data = io->readAll();
+        int64_t now = monotonicNs();
+
+        int channels = format.channelCount();
+        int bytesPerFrame = format.bytesPerFrame();
+        int frames = bytesPerFrame > 0 ? data.size() / bytesPerFrame : 0;
+        if (frames == 0) {
+            return;
+        }
+
+        // Downmix to mono floats
+        mono.resize(frames);
+        const char* frame = data.constData();
+        for (int i = 0; i < frames; ++i, frame += bytesPerFrame) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                sum += format.normalizedSampleValue(frame + c * format.bytesPerSample());
+            }
+            mono[i] = sum / channels;
+        }
+
+        deliver(mono.data(), frames, now);
+    }
+};
+
+// Fake input device that plays a WAV file in real time, for machines
+// without audio hardware and for repeatable latency measurements
+class FileAudioCapture : public LiveAudioCapture {
+    Q_OBJECT
+
+public:
+    FileAudioCapture(AudioBlockRing& ring, const QString& path, bool loop = true)
+        : LiveAudioCapture(ring), path(path), loop(loop) {}
+
+public slots:
+    void start() override {
+        QString error;
+        if (!loadWav(error)) {
+            emit failed(error);
+            return;
+        }
+
+        // Pace delivery like a device with a 5 ms period
+        timer = new QTimer(this);
+        timer->setTimerType(Qt::PreciseTimer);
+        connect(timer, &QTimer::timeout, this, &FileAudioCapture::pump);
+        deviceLatency = 2.5;
+        clock.start();
+        timer->start(5);
+    }
+
+    void stop() override {
+        if (timer) {
+            timer->stop();
+        }
+    }
+
+private:
+    QString path;
+    bool loop;
+    std::vector<float> samples; // Mono
+    size_t position = 0;
+    int64_t delivered = 0;
+    QElapsedTimer clock;
+    QTimer* timer = nullptr;
+
+    void pump() {
+        int64_t now = monotonicNs();
+        int64_t due = clock.nsecsElapsed() * rate.load() / 1000000000LL - delivered;
+
+        while (due > 0 && !samples.empty()) {
+            if (position >= samples.size()) {
+                if (!loop) {
+                    timer->stop();
+                    return;
+                }
+                position = 0;
+            }
+
+            int chunk = (int)std::min<int64_t>(due, (int64_t)(samples.size() - position));
+            // Frames still due after this chunk were "captured" later
+            int64_t endNs = now - (due - chunk) * 1000000000LL / rate.load();
+            deliver(&samples[position], chunk, endNs);
+            position += chunk;
+            delivered += chunk;
+            due -= chunk;
+        }
+    }
+
+    // PCM 16/24/32-bit integer or 32-bit float WAV, downmixed to mono
+    bool loadWav(QString& error) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            error = "Cannot open " + path;
+            return false;
+        }
+        QByteArray bytes = file.readAll();
+        const char* data = bytes.constData();
+
+        if (bytes.size() < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) {
+            error = path + " is not a WAV file";
+            return false;
+        }
+
+        int format = 0, channels = 0, bits = 0;
+        const char* pcm = nullptr;
+        qint64 pcmSize = 0;
+
+        for (qint64 offset = 12; offset + 8 <= bytes.size();) {
+            quint32 chunkSize;
+            memcpy(&chunkSize, data + offset + 4, 4);
+            const char* chunk = data + offset + 8;
+            qint64 available = std::min<qint64>(chunkSize, bytes.size() - offset - 8);
+
+            if (memcmp(data + offset, "fmt ", 4) == 0 && available >= 16) {
+                quint16 tag, ch, bitsPerSample;
+                quint32 sr;
+                memcpy(&tag, chunk, 2);
+                memcpy(&ch, chunk + 2, 2);
+                memcpy(&sr, chunk + 4, 4);
+                memcpy(&bitsPerSample, chunk + 14, 2);
+                if (tag == 0xFFFE && available >= 26) {
+                    memcpy(&tag, chunk + 24, 2); // WAVE_FORMAT_EXTENSIBLE sub-format
+                }
+                format = tag;
+                channels = ch;
+                bits = bitsPerSample;
+                rate = (int)sr;
+            } else if (memcmp(data + offset, "data", 4) == 0) {
+                pcm = chunk;
+                pcmSize = available;
+            }
+
+            offset += 8 + chunkSize + (chunkSize & 1);
+        }
+
+        bool supported = (format == 1 && (bits == 16 || bits == 24 || bits == 32)) || (format == 3 && bits == 32);
+        if (!pcm || channels <= 0 || rate.load() <= 0 || !supported) {
+            error = path + ": unsupported WAV format (need PCM 16/24/32-bit or float)";
+            return false;
+        }
+
+        int bytesPerSample = bits / 8;
+        qint64 frames = pcmSize / (bytesPerSample * channels);
+        samples.resize(frames);
+
+        for (qint64 i = 0; i < frames; ++i) {
+            float sum = 0.0f;
+            for (int c = 0; c < channels; ++c) {
+                const char* s = pcm + (i * channels + c) * bytesPerSample;
+                if (format == 3) {
+                    float v;
+                    memcpy(&v, s, 4);
+                    sum += v;
+                } else if (bits == 16) {
+                    qint16 v;
+                    memcpy(&v, s, 2);
+                    sum += v / 32768.0f;
+                } else if (bits == 24) {
+                    qint32 v = (qint32)((quint8)s[0] | ((quint8)s[1] << 8) | ((quint32)(qint8)s[2] << 16));
+                    sum += v / 8388608.0f;
+                } else {
+                    qint32 v;
+                    memcpy(&v, s, 4);
+                    sum += v / 2147483648.0f;
+                }
+            }
+            samples[i] = sum / channels;
+        }
+
+        qDebug() << "Fake audio input:" << path << rate.load() << "Hz," << frames << "frames";
+        return true;
+    }
+};
+
+// GUI-thread side: owns the capture thread, drains the ring into the
+// analyzer each animation tick and tracks input-to-photon latency
+class LiveAudioInput : public QObject {
+    Q_OBJECT
+
+public:
+    // 256-frame blocks (~5.8 ms at 44.1 kHz), up to ~190 ms of slack
+    LiveAudioInput(QObject* parent = nullptr) : QObject(parent), ring(32, 256) {}
+
+    ~LiveAudioInput() {
+        stop();
+    }
+
+    bool isRunning() const { return capture != nullptr; }
+
+    // Empty path: default input device; otherwise a WAV file as a fake device
+    void start(const QString& wavPath = QString()) {
+        stop();
+
+        // Levels, onset spacing, tempo and mood belong to the previous source
+        liveAnalyzer = LiveAudioAnalyzer();
+        analyzerRate = 0;
+
+        if (wavPath.isEmpty()) {
+            capture = new DeviceAudioCapture(ring, QMediaDevices::defaultAudioInput());
+        } else {
+            capture = new FileAudioCapture(ring, wavPath);
+        }
+
+        thread = new QThread(this);
+        capture->moveToThread(thread);
+        connect(thread, &QThread::started, capture, &LiveAudioCapture::start);
+        connect(thread, &QThread::finished, capture, &QObject::deleteLater);
+        connect(capture, &LiveAudioCapture::failed, this, &LiveAudioInput::failed);
+        thread->start(QThread::TimeCriticalPriority);
+
+        latencyWindow.start();
+        latencySum = 0.0;
+        latencyMax = 0.0;
+        latencyCount = 0;
+    }
+
+    void stop() {
+        if (!capture) {
+            return;
+        }
+
+        QMetaObject::invokeMethod(capture, &LiveAudioCapture::stop, Qt::BlockingQueuedConnection);
+        thread->quit();
+        thread->wait();
+        thread->deleteLater();
+        thread = nullptr;
+        capture = nullptr;
+
+        // Discard blocks left from this session
+        while (ring.pop(block)) {
+        }
+    }
+
+    // Feeds all captured blocks to the analyzer. Returns true if any
+    // contained an onset; newestCaptureNs is set when blocks were consumed.
+    bool process(int64_t& newestCaptureNs) {
+        int sampleRate = capture ? capture->sampleRate() : 0;
+        if (sampleRate > 0 && sampleRate != analyzerRate) {
+            analyzerRate = sampleRate;
+            liveAnalyzer.setSampleRate(sampleRate);
+        }
+
+        bool onset = false;
+        newestCaptureNs = 0;
+        while (ring.pop(block)) {
+            onset |= liveAnalyzer.processBlock(block.samples.data(), block.samples.size());
+            newestCaptureNs = block.captureNs;
+        }
+        return onset;
+    }
+
+    const LiveAudioAnalyzer& analyzer() const { return liveAnalyzer; }
+
+    // Called once a frame built from a block captured at captureNs is on screen
+    void framePresented(int64_t captureNs, int64_t presentedNs) {
+        double latencyMs = (presentedNs - captureNs) / 1.0e6 + (capture ? capture->deviceLatencyMs() : 0.0);
+        latencySum += latencyMs;
+        latencyMax = std::max(latencyMax, latencyMs);
+        ++latencyCount;
+
+        if (latencyWindow.elapsed() >= 2000 && latencyCount > 0) {
+            emit latencyReport(latencySum / latencyCount, latencyMax, ring.overruns());
+            latencyWindow.restart();
+            latencySum = 0.0;
+            latencyMax = 0.0;
+            latencyCount = 0;
+        }
+    }
+
+signals:
+    void failed(const QString& message);
+    void latencyReport(double meanMs, double maxMs, quint64 droppedBlocks);
+
+private:
+    AudioBlockRing ring;
+    AudioBlockRing::Block block;
+    LiveAudioCapture* capture = nullptr;
+    QThread* thread = nullptr;
+    LiveAudioAnalyzer liveAnalyzer;
+    int analyzerRate = 0;
+
+    QElapsedTimer latencyWindow;
+    double latencySum = 0.0;
+    double latencyMax = 0.0;
+    int latencyCount = 0;
+};
+
+#endif // LIVE_AUDIO_INPUT_H
@@ -9,6 +9,7 @@
 #include <QLabel>
 #include <QVector3D>
 #include <QProcess>
+#include <QProcessEnvironment>
 #include <QThread>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -22,9 +23,25 @@
 #include <QSlider>
 #include <QFile>
 #include <QElapsedTimer>
+#include <QScreen>
+#include <QCommandLineParser>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <iostream>
 #include <cmath>
 
+#include "visualizer_scene.h"
+#include "feature_timeline.h"
+#include "analysis_file.h"
+#include "quality_controller.h"
+#include "live_audio_input.h"
+
+// Started first thing in main(); startup metrics are measured from here
+static QElapsedTimer& launchTimer() {
+    static QElapsedTimer timer;
+    return timer;
+}
+
 // AnalysisClient class with improved resource management
 class AnalysisClient : public QObject {
     Q_OBJECT
@@ -40,10 +57,12 @@ public:
         QVector<float> waveform;
         QString predicted_mood;
         float mood_confidence = 0.0f;
+        FeatureTimeline timeline; // Beats, bars, onsets and feature series by time
     };
     
     AnalysisClient(QObject* parent = nullptr) : QObject(parent) {
         process = new QProcess(this);
+        process->setProcessEnvironment(pythonEnvironment());
         
         // Set up the Python path - try to find the venv Python
         QString projectDir = QApplication::applicationDirPath() + "/..";
@@ -61,7 +80,31 @@ public:
     
     // Added destructor for proper cleanup
     ~AnalysisClient() {
-        cleanupProcesses();
+        shutdown();
+    }
+    
+    // Spawns the long-lived Python worker so interpreter start, librosa/torch
+    // imports and JIT warm-up happen while the user is still picking a file
+    void prestartWorker() {
+        if (worker) {
+            return;
+        }
+        
+        worker = new QProcess(this);
+        worker->setProcessEnvironment(pythonEnvironment());
+        worker->setWorkingDirectory(QApplication::applicationDirPath() + "/..");
+        workerReady = false;
+        workerBusy = false;
+        workerOutput.clear();
+        workerText.clear();
+        
+        connect(worker, &QProcess::readyReadStandardOutput, this, &AnalysisClient::onWorkerOutput);
+        connect(worker, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
+                this, &AnalysisClient::onWorkerFinished);
+        
+        workerSpawnTimer.start();
+        worker->start(pythonExecutable, QStringList() << "main.py" << "worker");
+        qDebug() << "Pre-spawning analysis worker";
     }
     
     void analyzeFile(const QString& filePath) {
@@ -69,6 +112,34 @@ public:
         cleanupProcesses();
         
         emit analysisStarted();
+        requestTimer.start();
+        
+        // A track analyzed before is loaded from its cached analysis file
+        QString analysisPath = analysisPathFor(filePath);
+        QFileInfo cached(analysisPath);
+        if (cached.exists() && cached.lastModified() >= QFileInfo(filePath).lastModified()) {
+            AnalysisResult result;
+            if (loadAnalysis(analysisPath, result)) {
+                qDebug() << "Loaded cached analysis:" << analysisPath;
+                QTimer::singleShot(0, this, [this, result]() { emit analysisCompleted(result); });
+                return;
+            }
+        }
+        QFile::remove(analysisPath);
+        
+        // Prefer the warm worker; requests sent while it is still warming up
+        // wait in its stdin
+        if (worker && worker->state() != QProcess::NotRunning && !workerBusy) {
+            QJsonObject request;
+            request["command"] = "analyze";
+            request["file"] = filePath;
+            request["output"] = analysisPath;
+            
+            workerBusy = true;
+            workerAnalysisPath = analysisPath;
+            worker->write(QJsonDocument(request).toJson(QJsonDocument::Compact) + "\n");
+            return;
+        }
         
         // Set working directory to project root
         QString projectDir = QApplication::applicationDirPath() + "/..";
@@ -76,21 +147,16 @@ public:
         
         // Prepare Python command
         QStringList arguments;
-        arguments << "main.py" << "analyze" << filePath;
+        arguments << "main.py" << "analyze" << filePath << "--classify" << "--output" << analysisPath;
         
         connect(process, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, [this, filePath](int exitCode, QProcess::ExitStatus exitStatus) {
+                this, [this, analysisPath](int exitCode, QProcess::ExitStatus exitStatus) {
                     Q_UNUSED(exitStatus)
                     qDebug() << "Analysis process finished with exit code:" << exitCode;
                     
                     AnalysisResult result;
                     if (exitCode == 0) {
-                        // Parse the output
-                        QString output = process->readAllStandardOutput();
-                        parseAnalysisOutput(output, result);
-                        
-                        // Now run mood classification
-                        runMoodClassification(filePath);
+                        finishAnalysis(process->readAllStandardOutput(), analysisPath);
                     } else {
                         result.success = false;
                         QString stderrOutput = process->readAllStandardError();
@@ -107,6 +173,25 @@ public:
         process->start(pythonExecutable, arguments);
     }
     
+    // Stops all Python processes for good. Unlike cleanupProcesses(), the
+    // worker is disconnected before it is killed so it is not respawned.
+    void shutdown() {
+        if (worker) {
+            worker->disconnect(this);
+            worker->kill();
+            worker->waitForFinished(1000);
+            worker->deleteLater();
+            worker = nullptr;
+            workerBusy = false;
+        }
+        cleanupProcesses();
+    }
+    
+    // Milliseconds since the last analyzeFile() call
+    qint64 requestElapsed() const {
+        return requestTimer.isValid() ? requestTimer.elapsed() : 0;
+    }
+    
     // Added cleanup function
     void cleanupProcesses() {
         if (process && process->state() != QProcess::NotRunning) {
@@ -114,9 +199,15 @@ public:
             process->waitForFinished(1000);
         }
         
-        // Clean up any lingering mood classification processes
+        // An idle worker is kept warm; a busy one is restarted by onWorkerFinished
+        if (worker && workerBusy) {
+            worker->kill();
+            worker->waitForFinished(1000);
+        }
+        
+        // Clean up any other lingering processes
         for (auto* proc : findChildren<QProcess*>()) {
-            if (proc != process && proc->state() != QProcess::NotRunning) {
+            if (proc != process && proc != worker && proc->state() != QProcess::NotRunning) {
                 proc->kill();
                 proc->waitForFinished(500);
             }
@@ -127,77 +218,166 @@ signals:
     void analysisStarted();
     void analysisCompleted(const AnalysisResult& result);
     
-private:
-    QString pythonExecutable;
-    QProcess* process;
-    AnalysisResult tempResult;
-    
-    void parseAnalysisOutput(const QString& output, AnalysisResult& result) {
-        result.success = true;
+private slots:
+    void onWorkerOutput() {
+        workerOutput += worker->readAllStandardOutput();
         
-        // Parse duration
-        QRegularExpression durationRegex("Duration: ([\\d\\.]+) seconds");
-        QRegularExpressionMatch match = durationRegex.match(output);
-        if (match.hasMatch()) {
-            result.duration = match.captured(1).toFloat();
+        int newline;
+        while ((newline = workerOutput.indexOf('\n')) >= 0) {
+            QString line = QString::fromUtf8(workerOutput.left(newline)).trimmed();
+            workerOutput.remove(0, newline + 1);
+            
+            if (line.startsWith("@@READY")) {
+                workerReady = true;
+                std::cout << "Analysis worker ready: " << workerSpawnTimer.elapsed() << " ms after spawn ("
+                          << line.mid(8).toStdString() << ")" << std::endl;
+            } else if (line == "@@END") {
+                finishWorkerRequest(workerText);
+                workerText.clear();
+            } else {
+                workerText += line + "\n";
+            }
         }
+    }
+    
+    void onWorkerFinished(int exitCode, QProcess::ExitStatus exitStatus) {
+        Q_UNUSED(exitStatus)
+        qDebug() << "Analysis worker exited with code:" << exitCode;
         
-        // Parse tempo
-        QRegularExpression tempoRegex("Tempo: ([\\d\\.]+) BPM");
-        match = tempoRegex.match(output);
-        if (match.hasMatch()) {
-            result.tempo = match.captured(1).toFloat();
+        bool wasReady = workerReady;
+        bool wasBusy = workerBusy;
+        worker->deleteLater();
+        worker = nullptr;
+        workerBusy = false;
+        
+        if (wasBusy) {
+            AnalysisResult result;
+            result.error_message = QString("Analysis worker exited (code %1)").arg(exitCode);
+            emit analysisCompleted(result);
         }
         
-        // Store this result temporarily
-        tempResult = result;
+        // Respawn after a crash or kill, but not if it never started properly
+        if (wasReady) {
+            prestartWorker();
+        }
     }
     
-    void runMoodClassification(const QString& filePath) {
-        // Create a new process for mood classification
-        QProcess* moodProcess = new QProcess(this);
-        QString projectDir = QApplication::applicationDirPath() + "/..";
-        moodProcess->setWorkingDirectory(projectDir);
+private:
+    QString pythonExecutable;
+    QProcess* process;
+    
+    QProcess* worker = nullptr;
+    bool workerReady = false;
+    bool workerBusy = false;
+    QByteArray workerOutput;  // Unterminated stdout bytes
+    QString workerText;       // Lines of the request in progress
+    QString workerAnalysisPath;
+    QElapsedTimer workerSpawnTimer;
+    QElapsedTimer requestTimer;
+    
+    // Python's stdio defaults to the locale code page on Windows; requests and
+    // output (including track paths) are exchanged as UTF-8
+    static QProcessEnvironment pythonEnvironment() {
+        QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+        env.insert("PYTHONUTF8", "1");
+        env.insert("PYTHONIOENCODING", "utf-8");
+        return env;
+    }
+    
+    void finishWorkerRequest(const QString& output) {
+        workerBusy = false;
+        finishAnalysis(output, workerAnalysisPath);
+    }
+    
+    // Results come from the analysis file; the text output only carries errors
+    void finishAnalysis(const QString& output, const QString& analysisPath) {
+        AnalysisResult result;
+        if (!loadAnalysis(analysisPath, result)) {
+            QRegularExpressionMatch match = QRegularExpression("Error: (.*)").match(output);
+            result.error_message = match.hasMatch() ? match.captured(1) : QString("Analysis produced no results");
+        }
+        emit analysisCompleted(result);
+    }
+    
+    // One analysis file per track in the cache, keyed by its full path
+    static QString analysisPathFor(const QString& filePath) {
+        QString analysisDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/analyses";
+        QDir().mkpath(analysisDir);
+        QByteArray key = QCryptographicHash::hash(QFileInfo(filePath).absoluteFilePath().toUtf8(),
+                                                  QCryptographicHash::Md5).toHex().left(12);
+        return analysisDir + "/" + QFileInfo(filePath).completeBaseName() + "_" + key + ".mva";
+    }
+    
+    static bool loadAnalysis(const QString& analysisPath, AnalysisResult& result) {
+        AnalysisFile file;
+        std::string error;
+        if (!file.open(analysisPath.toStdString(), &error)) {
+            qDebug() << "No analysis file:" << analysisPath << QString::fromStdString(error);
+            return false;
+        }
         
-        QStringList arguments;
-        arguments << "main.py" << "classify" << filePath;
+        result.success = true;
+        result.duration = (float)file.duration();
+        result.sample_rate = (int)file.sampleRate();
+        result.tempo = file.tempo();
         
-        connect(moodProcess, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished),
-                this, [this, moodProcess](int exitCode, QProcess::ExitStatus exitStatus) {
-                    Q_UNUSED(exitStatus)
-                    
-                    if (exitCode == 0) {
-                        QString output = moodProcess->readAllStandardOutput();
-                        parseMoodOutput(output, tempResult);
-                    } else {
-                        // Set default mood if classification fails
-                        tempResult.predicted_mood = "energetic";
-                        tempResult.mood_confidence = 0.5f;
-                    }
-                    
-                    emit analysisCompleted(tempResult);
-                    
-                    // Ensure cleanup after completion
-                    moodProcess->deleteLater();
-                });
+        AnalysisFile::Span<float> beats = file.events("beats");
+        result.beat_times = QVector<float>(beats.begin(), beats.end());
+        AnalysisFile::Span<float> waveform = file.series("waveform").values;
+        result.waveform = QVector<float>(waveform.begin(), waveform.end());
         
-        moodProcess->start(pythonExecutable, arguments);
-    }
-    
-    void parseMoodOutput(const QString& output, AnalysisResult& result) {
-        // Parse predicted mood
-        QRegularExpression moodRegex("Predicted mood: (\\w+)");
-        QRegularExpressionMatch match = moodRegex.match(output);
-        if (match.hasMatch()) {
-            result.predicted_mood = match.captured(1);
+        result.predicted_mood = QString::fromStdString(file.predictedMood());
+        result.mood_confidence = file.moodConfidence();
+        if (result.predicted_mood.isEmpty()) {
+            // Same default as before when classification fails
+            result.predicted_mood = "energetic";
+            result.mood_confidence = 0.5f;
         }
         
-        // Parse confidence
-        QRegularExpression confidenceRegex("Confidence: ([\\d\\.]+)");
-        match = confidenceRegex.match(output);
-        if (match.hasMatch()) {
-            result.mood_confidence = match.captured(1).toFloat();
+        result.timeline = file.toTimeline();
+        return true;
+    }
+};
+
+// Replays the shared scene geometry through the fixed-function GL pipeline
+class GLSceneCanvas : public SceneCanvas {
+public:
+    void drawLineStrip(const std::vector<ScenePoint>& points, const SceneColor& color, float width) override {
+        glLineWidth(width);
+        glBegin(GL_LINE_STRIP);
+        glColor4f(color.r, color.g, color.b, color.a);
+        for (const ScenePoint& p : points) {
+            glVertex2f(p.x, p.y);
+        }
+        glEnd();
+    }
+
+    void drawTriangleFan(const std::vector<ScenePoint>& points, const SceneColor& color) override {
+        glBegin(GL_TRIANGLE_FAN);
+        glColor4f(color.r, color.g, color.b, color.a);
+        for (const ScenePoint& p : points) {
+            glVertex2f(p.x, p.y);
+        }
+        glEnd();
+    }
+
+    void drawQuad(const ScenePoint (&corners)[4], const SceneColor& color) override {
+        glBegin(GL_QUADS);
+        glColor4f(color.r, color.g, color.b, color.a);
+        for (const ScenePoint& p : corners) {
+            glVertex2f(p.x, p.y);
+        }
+        glEnd();
+    }
+
+    void drawPoints(const std::vector<ScenePoint>& points, const std::vector<SceneColor>& colors, float size) override {
+        glPointSize(size);
+        glBegin(GL_POINTS);
+        for (size_t i = 0; i < points.size() && i < colors.size(); ++i) {
+            glColor4f(colors[i].r, colors[i].g, colors[i].b, colors[i].a);
+            glVertex2f(points[i].x, points[i].y);
         }
+        glEnd();
     }
 };
 
@@ -208,11 +388,16 @@ public:
     VisualizerWidget(QWidget *parent = nullptr) : QOpenGLWidget(parent) {
         // Setup timer for animation
         animationTimer = new QTimer(this);
+        animationTimer->setTimerType(Qt::PreciseTimer);
         connect(animationTimer, &QTimer::timeout, this, &VisualizerWidget::animate);
-        animationTimer->start(16); // ~60 FPS
+        animationTimer->start(timerInterval()); // ~60 FPS with the default budget
+        
+        // Input-to-photon latency is measured when the frame reaches the screen
+        connect(this, &QOpenGLWidget::frameSwapped, this, &VisualizerWidget::onFrameSwapped);
         
         // Initialize animation time
         animationTime.start();
+        playbackClock.start();
         
         // Initialize default values
         beatIntensity = 0.0f;
@@ -233,17 +418,15 @@ public:
             currentTempo = result.tempo;
             currentDuration = result.duration;
             
+            // Per-frame lookups by playback time; ids resolved once here
+            timeline = result.timeline;
+            beatsId = timeline.eventsId("beats");
+            rmsId = timeline.seriesId("rms");
+            
             // Set mood color based on detected mood
-            if (result.predicted_mood == "happy") {
-                setMoodColor(QVector3D(1.0f, 0.7f, 0.0f));
-            } else if (result.predicted_mood == "sad") {
-                setMoodColor(QVector3D(0.2f, 0.3f, 0.8f));
-            } else if (result.predicted_mood == "energetic") {
-                setMoodColor(QVector3D(1.0f, 0.0f, 0.3f));
-            } else if (result.predicted_mood == "calm") {
-                setMoodColor(QVector3D(0.3f, 0.8f, 0.5f));
-            } else if (result.predicted_mood == "angry") {
-                setMoodColor(QVector3D(0.9f, 0.1f, 0.1f));
+            float r, g, b;
+            if (visualizerMoodColor(result.predicted_mood.toStdString(), r, g, b)) {
+                setMoodColor(QVector3D(r, g, b));
             }
         }
     }
@@ -253,10 +436,32 @@ public:
         beatIntensity = 1.0f;
         animationTime.restart();
         frameCount = 0; // Reset frame counter
+        playbackPosition = 0;
+        playbackClock.restart();
+        lastBeatQuery = 0.0f;
         
         // Reset animation timer to prevent accumulation of timing errors
         animationTimer->stop();
-        animationTimer->start(16);
+        animationTimer->start(timerInterval());
+    }
+    
+    // Target frame time in ms (e.g. 16.6 or 8.3); geometry detail adapts to hold it
+    void setFrameBudget(float budgetMs) {
+        qualityController.setBudgetMs(budgetMs);
+        animationTimer->start(timerInterval());
+    }
+    
+    // Drive the visualizer from live capture instead of file playback; nullptr to detach
+    void setLiveInput(LiveAudioInput* input) {
+        liveInput = input;
+        liveMood.clear();
+        pendingCaptureNs = 0;
+    }
+    
+    // Pins geometry detail to one level (0 = lowest) and stops adapting
+    void setFixedQuality(int level) {
+        qualityController.setAdaptive(false);
+        qualityController.setLevel(level);
     }
     
     void stopAnimation() {
@@ -266,10 +471,10 @@ public:
     }
     
     void setPlaybackProgress(qint64 position, qint64 duration) {
-        if (duration > 0) {
-            float progress = (float)position / duration;
-            // Could be used for more precise sync
-        }
+        Q_UNUSED(duration)
+        // Position updates are coarse; playbackSeconds() extrapolates between them
+        playbackPosition = position;
+        playbackClock.restart();
     }
     
     // Added function to reset visualization state
@@ -279,6 +484,9 @@ public:
         beatIntensity = 0.0f;
         currentTempo = 120.0f;
         frameCount = 0;
+        timeline = FeatureTimeline();
+        beatsId = -1;
+        rmsId = -1;
         animationTime.restart();
         update();
     }
@@ -293,20 +501,44 @@ protected:
     }
 
     void paintGL() override {
+        QElapsedTimer paintTimer;
+        paintTimer.start();
+        
         // Update background color based on mood
         glClearColor(moodColor.x() * 0.1f, moodColor.y() * 0.1f, moodColor.z() * 0.1f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
         
         if (isPlaying) {
             // Draw visualizations
-            drawWaveform();
-            drawBeatIndicator();
-            drawFrequencyBars();
-            drawMoodParticles();
+            GLSceneCanvas canvas;
+            drawVisualizerScene(sceneState(), canvas);
         }
         
         // Increment frame counter for performance monitoring
         frameCount++;
+        
+        // Feed frame timing to the quality controller while animating
+        if (isPlaying) {
+            if (qualityController.isAdaptive()) {
+                // GL calls only queue work; wait for the GPU (or the software
+                // rasterizer, which runs at flush) so the real frame cost is timed
+                glFinish();
+                qreal refreshRate = screen() ? screen()->refreshRate() : 0.0;
+                qualityController.setDisplayIntervalMs(refreshRate > 0.0 ? 1000.0f / (float)refreshRate : 0.0f);
+            }
+            float workMs = paintTimer.nsecsElapsed() / 1.0e6f;
+            float intervalMs = frameClock.isValid() ? frameClock.nsecsElapsed() / 1.0e6f : workMs;
+            if (qualityController.addFrame(intervalMs, workMs, launchTimer().elapsed() / 1000.0)) {
+                qDebug() << "Visual quality level" << qualityController.level()
+                         << "for a" << qualityController.budgetMs() << "ms frame budget";
+            }
+        }
+        frameClock.start();
+        
+        if (!firstFrameReported) {
+            firstFrameReported = true;
+            std::cout << "Time to first frame: " << launchTimer().elapsed() << " ms" << std::endl;
+        }
     }
 
     void resizeGL(int w, int h) override {
@@ -321,17 +553,28 @@ protected:
 private slots:
     void animate() {
         if (isPlaying) {
-            // Update beat intensity decay
-            beatIntensity *= 0.98f;
-            
-            // Use actual tempo if analyzed, otherwise default
-            float time = animationTime.elapsed() / 1000.0f;
-            float beatInterval = 60.0f / currentTempo; // Convert BPM to seconds per beat
-            
-            // Trigger beat based on actual tempo
-            if (fmod(time, beatInterval) < 0.1f && beatIntensity < 0.5f) {
-                beatIntensity = 1.0f;
+            // Beat decay and trigger, shared with the headless renderer
+            VisualizerSceneState state = sceneState();
+            if (liveInput && liveInput->isRunning()) {
+                // Onsets from the captured blocks act as beats
+                int64_t captureNs = 0;
+                stepVisualizerBeat(state, liveInput->process(captureNs));
+                if (captureNs) {
+                    pendingCaptureNs = captureNs;
+                }
+                updateLiveAnalysis();
+            } else if (beatsId >= 0) {
+                // Detected beats since the last tick; a backwards seek restarts the window
+                float now = playbackSeconds();
+                if (now < lastBeatQuery) {
+                    lastBeatQuery = now;
+                }
+                stepVisualizerBeat(state, !timeline.eventsIn(beatsId, lastBeatQuery, now).empty());
+                lastBeatQuery = now;
+            } else {
+                stepVisualizerBeat(state);
             }
+            beatIntensity = state.beatIntensity;
             
             // Periodically reset timer to prevent drift (every 30 seconds)
             if (frameCount % (30 * 60) == 0) {
@@ -342,6 +585,13 @@ private slots:
         
         update(); // Triggers paintGL
     }
+    
+    void onFrameSwapped() {
+        if (liveInput && pendingCaptureNs) {
+            liveInput->framePresented(pendingCaptureNs, monotonicNs());
+            pendingCaptureNs = 0;
+        }
+    }
 
 private:
     QTimer *animationTimer;
@@ -353,89 +603,57 @@ private:
     float currentTempo;
     float currentDuration;
     qint64 frameCount; // Added for performance monitoring
+    bool firstFrameReported = false;
+    AdaptiveQualityController qualityController;
+    QElapsedTimer frameClock; // Time since the previous paintGL
+    LiveAudioInput* liveInput = nullptr;
+    int64_t pendingCaptureNs = 0; // Newest block drawn in the frame being presented
+    std::string liveMood;
     
-    void drawWaveform() {
-        // Enhanced waveform based on analysis
-        float time = animationTime.elapsed() / 1000.0f;
-        float tempoMultiplier = currentTempo / 120.0f; // Normalize to 120 BPM
-        
-        glLineWidth(2.0f);
-        glBegin(GL_LINE_STRIP);
-        glColor4f(moodColor.x(), moodColor.y(), moodColor.z(), 0.8f);
-        
-        for (float x = -1.0f; x <= 1.0f; x += 0.01f) {
-            float y = 0.3f * sin(x * 10.0f + time * 3.0f * tempoMultiplier) * (1.0f + beatIntensity * 0.5f);
-            glVertex2f(x, y);
+    void updateLiveAnalysis() {
+        const LiveAudioAnalyzer& analyzer = liveInput->analyzer();
+        if (analyzer.tempo() > 0.0f) {
+            currentTempo = analyzer.tempo();
         }
         
-        glEnd();
+        float r, g, b;
+        if (analyzer.mood() != liveMood && visualizerMoodColor(analyzer.mood(), r, g, b)) {
+            liveMood = analyzer.mood();
+            setMoodColor(QVector3D(r, g, b));
+        }
     }
     
-    void drawBeatIndicator() {
-        if (beatIntensity > 0.1f) {
-            float radius = 0.05f + 0.1f * beatIntensity;
-            int segments = 32;
-            
-            glBegin(GL_TRIANGLE_FAN);
-            glColor4f(1.0f, 1.0f, 1.0f, beatIntensity);
-            glVertex2f(0.0f, 0.8f);
-            
-            for (int i = 0; i <= segments; ++i) {
-                float angle = i * 2.0f * M_PI / segments;
-                float x = radius * cos(angle);
-                float y = 0.8f + radius * sin(angle);
-                glVertex2f(x, y);
-            }
-            
-            glEnd();
-        }
+    int timerInterval() const {
+        return std::max(1, (int)qualityController.budgetMs());
     }
+    FeatureTimeline timeline;
+    int beatsId = -1;
+    int rmsId = -1;
+    qint64 playbackPosition = 0; // Last reported media position in ms
+    QElapsedTimer playbackClock; // Time since that report
+    float lastBeatQuery = 0.0f;
     
-    void drawFrequencyBars() {
-        // Enhanced frequency visualization
-        int numBars = 32;
-        float barWidth = 2.0f / numBars;
-        float time = animationTime.elapsed() / 1000.0f;
-        float tempoMultiplier = currentTempo / 120.0f;
-        
-        for (int i = 0; i < numBars; ++i) {
-            float intensity = 0.3f + 0.5f * sin(i * 0.3f + time * 2.0f * tempoMultiplier);
-            intensity *= (1.0f + beatIntensity * 0.5f);
-            
-            float x = -1.0f + i * barWidth;
-            float height = intensity * 0.6f;
-            
-            // Color based on frequency (blue to red across spectrum)
-            float colorPhase = (float)i / numBars;
-            glBegin(GL_QUADS);
-            glColor4f(colorPhase * moodColor.x(), (1.0f - colorPhase) * moodColor.y(), moodColor.z(), 0.7f);
-            glVertex2f(x, -0.8f);
-            glVertex2f(x + barWidth * 0.8f, -0.8f);
-            glVertex2f(x + barWidth * 0.8f, -0.8f + height);
-            glVertex2f(x, -0.8f + height);
-            glEnd();
-        }
+    float playbackSeconds() const {
+        return (playbackPosition + playbackClock.elapsed()) / 1000.0f;
     }
     
-    void drawMoodParticles() {
-        // Enhanced particle system
-        int numParticles = 50;
-        float time = animationTime.elapsed() * 0.001f;
-        
-        glPointSize(3.0f);
-        glBegin(GL_POINTS);
-        
-        for (int i = 0; i < numParticles; ++i) {
-            float t = time + i * 0.1f;
-            float x = sin(t * 0.5f + i) * 0.8f;
-            float y = sin(t * 0.3f + i * 2.0f) * 0.8f;
-            float alpha = (0.5f + 0.5f * sin(t * 2.0f + i)) * beatIntensity;
-            
-            glColor4f(moodColor.x(), moodColor.y(), moodColor.z(), alpha * 0.5f);
-            glVertex2f(x, y);
+    // Snapshot of the animation state in backend-independent form
+    VisualizerSceneState sceneState() const {
+        VisualizerSceneState state;
+        state.time = animationTime.elapsed() / 1000.0f;
+        state.beatIntensity = beatIntensity;
+        state.tempo = currentTempo; // Actual tempo if analyzed, otherwise default
+        if (liveInput && liveInput->isRunning()) {
+            state.spectrum = liveInput->analyzer().bands();
+            state.energy = 0.5f + 0.5f * liveInput->analyzer().energy();
+        } else if (rmsId >= 0 && timeline.peak(rmsId) > 0.0f) {
+            state.energy = 0.5f + 0.5f * timeline.valueAt(rmsId, playbackSeconds()) / timeline.peak(rmsId);
         }
-        
-        glEnd();
+        state.moodR = moodColor.x();
+        state.moodG = moodColor.y();
+        state.moodB = moodColor.z();
+        state.quality = qualityController.quality();
+        return state;
     }
 };
 
@@ -447,19 +665,14 @@ public:
         setWindowTitle("AI Music Visualizer");
         setMinimumSize(800, 600);
         
-        // Initialize audio components - keeping the original working implementation
-        mediaPlayer = new QMediaPlayer(this);
-        audioOutput = new QAudioOutput(this);
-        mediaPlayer->setAudioOutput(audioOutput);
+        // Audio components are created on first load (ensureMediaPlayer) so
+        // multimedia backend start-up stays off the path to the first frame
         
-        // Connect media player signals
-        connect(mediaPlayer, &QMediaPlayer::positionChanged, this, &MainWindow::updatePosition);
-        connect(mediaPlayer, &QMediaPlayer::durationChanged, this, &MainWindow::updateDuration);
-        
-        // Initialize analysis client
+        // Initialize analysis client; its worker is spawned once the window is up
         analysisClient = new AnalysisClient(this);
         connect(analysisClient, &AnalysisClient::analysisCompleted,
                 this, &MainWindow::onAnalysisCompleted);
+        QTimer::singleShot(0, analysisClient, &AnalysisClient::prestartWorker);
         
         // Create central widget and layout
         QWidget *centralWidget = new QWidget(this);
@@ -486,6 +699,7 @@ public:
         QPushButton *stopButton = new QPushButton("Stop", this);
         QPushButton *refreshButton = new QPushButton("Refresh", this); // Added refresh button
         QPushButton *exportButton = new QPushButton("Export Video", this);
+        QPushButton *liveButton = new QPushButton("Live Input", this);
         
         analyzeButton->setEnabled(false);
         
@@ -495,6 +709,13 @@ public:
         connect(stopButton, &QPushButton::clicked, this, &MainWindow::stopAudio);
         connect(refreshButton, &QPushButton::clicked, this, &MainWindow::refreshApplication);
         connect(exportButton, &QPushButton::clicked, this, &MainWindow::exportVideo);
+        connect(liveButton, &QPushButton::clicked, this, [this]() {
+            if (liveInput && liveInput->isRunning()) {
+                stopAudio();
+            } else {
+                startLiveInput();
+            }
+        });
         
         buttonLayout->addWidget(loadButton);
         buttonLayout->addWidget(analyzeButton);
@@ -502,6 +723,7 @@ public:
         buttonLayout->addWidget(stopButton);
         buttonLayout->addWidget(refreshButton);
         buttonLayout->addWidget(exportButton);
+        buttonLayout->addWidget(liveButton);
         
         // Audio controls
         QHBoxLayout *audioLayout = new QHBoxLayout();
@@ -549,11 +771,67 @@ public:
         this->refreshButton = refreshButton;
     }
     
+    void openAudioFile(const QString& fileName) {
+        statusLabel->setText(QString("Loaded: %1").arg(QFileInfo(fileName).baseName()));
+        currentFile = fileName;
+        analyzeButton->setEnabled(true);
+        
+        // Load audio file into media player
+        ensureMediaPlayer();
+        mediaPlayer->setSource(QUrl::fromLocalFile(fileName));
+        
+        std::cout << "Loading audio file: " << fileName.toStdString() << std::endl;
+    }
+    
+    void setFrameBudget(float budgetMs) {
+        visualizer->setFrameBudget(budgetMs);
+    }
+    
+    void setFixedQuality(int level) {
+        visualizer->setFixedQuality(level);
+    }
+    
+    // Visualize a live input device, or a WAV file standing in for one
+    void startLiveInput(const QString& wavPath = QString()) {
+        if (mediaPlayer) {
+            mediaPlayer->stop();
+        }
+        
+        if (!liveInput) {
+            liveInput = new LiveAudioInput(this);
+            connect(liveInput, &LiveAudioInput::failed, this, [this](const QString& message) {
+                statusLabel->setText("Live input failed: " + message);
+                stopAudio();
+            });
+            connect(liveInput, &LiveAudioInput::latencyReport, this,
+                    [this](double meanMs, double maxMs, quint64 droppedBlocks) {
+                statusLabel->setText(QString("Live input - latency %1 ms (max %2 ms)")
+                                     .arg(meanMs, 0, 'f', 1).arg(maxMs, 0, 'f', 1));
+                std::cout << "Input-to-photon latency: mean " << meanMs << " ms, max " << maxMs
+                          << " ms, dropped blocks " << droppedBlocks << std::endl;
+            });
+        }
+        
+        liveInput->start(wavPath);
+        visualizer->setLiveInput(liveInput);
+        visualizer->startAnimation();
+        statusLabel->setText(wavPath.isEmpty() ? QString("Live input from default device...")
+                                               : QString("Live input from file: %1").arg(QFileInfo(wavPath).fileName()));
+    }
+    
+    // Loads and analyzes a file at launch, prints the startup metrics and quits
+    void runStartupBenchmark(const QString& fileName) {
+        benchmarkMode = true;
+        analysisClient->prestartWorker();
+        openAudioFile(fileName);
+        analyzeAudio();
+    }
+    
     // Added destructor for cleanup
     ~MainWindow() {
         stopAudio();
         if (analysisClient) {
-            analysisClient->cleanupProcesses();
+            analysisClient->shutdown();
         }
     }
 
@@ -563,14 +841,7 @@ private slots:
             tr("Open Audio File"), "", tr("Audio Files (*.wav *.mp3)"));
         
         if (!fileName.isEmpty()) {
-            statusLabel->setText(QString("Loaded: %1").arg(QFileInfo(fileName).baseName()));
-            currentFile = fileName;
-            analyzeButton->setEnabled(true);
-            
-            // Load audio file into media player
-            mediaPlayer->setSource(QUrl::fromLocalFile(fileName));
-            
-            std::cout << "Loading audio file: " << fileName.toStdString() << std::endl;
+            openAudioFile(fileName);
         }
     }
     
@@ -585,6 +856,12 @@ private slots:
     void onAnalysisCompleted(const AnalysisClient::AnalysisResult& result) {
         analyzeButton->setEnabled(true);
         
+        std::cout << "Analysis took " << analysisClient->requestElapsed() << " ms" << std::endl;
+        if (!firstAnalysisReported) {
+            firstAnalysisReported = true;
+            std::cout << "Time to first analysis: " << launchTimer().elapsed() << " ms" << std::endl;
+        }
+        
         if (result.success) {
             statusLabel->setText(QString("Analysis complete - Tempo: %1 BPM, Mood: %2")
                                 .arg(result.tempo)
@@ -594,10 +871,18 @@ private slots:
         } else {
             statusLabel->setText("Analysis failed: " + result.error_message);
         }
+        
+        if (benchmarkMode) {
+            QTimer::singleShot(0, qApp, &QApplication::quit);
+        }
     }
     
     void playAudio() {
         if (!currentFile.isEmpty()) {
+            if (liveInput && liveInput->isRunning()) {
+                liveInput->stop();
+                visualizer->setLiveInput(nullptr);
+            }
             statusLabel->setText("Playing audio and visualization...");
             visualizer->startAnimation();
             mediaPlayer->play();
@@ -610,7 +895,13 @@ private slots:
     void stopAudio() {
         statusLabel->setText("Stopped");
         visualizer->stopAnimation();
-        mediaPlayer->stop();
+        if (mediaPlayer) {
+            mediaPlayer->stop();
+        }
+        if (liveInput && liveInput->isRunning()) {
+            liveInput->stop();
+            visualizer->setLiveInput(nullptr);
+        }
         std::cout << "Stopping audio and visualization..." << std::endl;
     }
     
@@ -626,8 +917,10 @@ private slots:
         visualizer->resetVisualization();
         
         // Reset media player
-        mediaPlayer->stop();
-        mediaPlayer->setSource(QUrl());
+        if (mediaPlayer) {
+            mediaPlayer->stop();
+            mediaPlayer->setSource(QUrl());
+        }
         
         // Reset UI state
         analyzeButton->setEnabled(false);
@@ -649,19 +942,17 @@ private slots:
     }
     
     void setMood(const QString& mood) {
-        QVector3D color;
-        if (mood == "happy") color = QVector3D(1.0f, 0.7f, 0.0f);
-        else if (mood == "sad") color = QVector3D(0.2f, 0.3f, 0.8f);
-        else if (mood == "energetic") color = QVector3D(1.0f, 0.0f, 0.3f);
-        else if (mood == "calm") color = QVector3D(0.3f, 0.8f, 0.5f);
-        else if (mood == "angry") color = QVector3D(0.9f, 0.1f, 0.1f);
-        
-        visualizer->setMoodColor(color);
+        float r = 0.0f, g = 0.0f, b = 0.0f;
+        visualizerMoodColor(mood.toStdString(), r, g, b);
+        
+        visualizer->setMoodColor(QVector3D(r, g, b));
         statusLabel->setText(QString("Manual mood override: %1").arg(mood));
     }
     
     void setVolume(int value) {
-        audioOutput->setVolume(value / 100.0f);
+        if (audioOutput) {
+            audioOutput->setVolume(value / 100.0f);
+        }
     }
     
     void updatePosition(qint64 position) {
@@ -680,17 +971,59 @@ private:
     AnalysisClient *analysisClient;
     QPushButton *analyzeButton;
     QPushButton *refreshButton; // Added refresh button reference
-    QMediaPlayer *mediaPlayer;
-    QAudioOutput *audioOutput;
+    QMediaPlayer *mediaPlayer = nullptr;
+    QAudioOutput *audioOutput = nullptr;
     QSlider *volumeSlider;
+    bool firstAnalysisReported = false;
+    bool benchmarkMode = false;
+    LiveAudioInput *liveInput = nullptr;
+    
+    void ensureMediaPlayer() {
+        if (mediaPlayer) {
+            return;
+        }
+        
+        mediaPlayer = new QMediaPlayer(this);
+        audioOutput = new QAudioOutput(this);
+        mediaPlayer->setAudioOutput(audioOutput);
+        audioOutput->setVolume(volumeSlider->value() / 100.0f);
+        
+        // Connect media player signals
+        connect(mediaPlayer, &QMediaPlayer::positionChanged, this, &MainWindow::updatePosition);
+        connect(mediaPlayer, &QMediaPlayer::durationChanged, this, &MainWindow::updateDuration);
+    }
 };
 
 int main(int argc, char *argv[]) {
+    launchTimer().start();
     QApplication app(argc, argv);
     
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addOption({ "benchmark-startup", "Analyze <file> at launch, report startup times and exit.", "file" });
+    parser.addOption({ "frame-budget", "Target frame time in ms; visual detail adapts to hold it.", "ms", "16.6" });
+    parser.addOption({ "quality", "Fixed visual quality level 0-4 instead of adapting.", "level" });
+    parser.addOption({ "live-input", "Start visualizing the default audio input device." });
+    parser.addOption({ "live-input-file", "Start live mode fed by <wav> as a fake input device.", "wav" });
+    parser.process(app);
+    
     MainWindow window;
+    window.setFrameBudget(parser.value("frame-budget").toFloat());
+    if (parser.isSet("quality")) {
+        window.setFixedQuality(parser.value("quality").toInt());
+    }
     window.show();
     
+    if (parser.isSet("live-input-file")) {
+        window.startLiveInput(parser.value("live-input-file"));
+    } else if (parser.isSet("live-input")) {
+        window.startLiveInput();
+    }
+    
+    if (parser.isSet("benchmark-startup")) {
+        window.runStartupBenchmark(parser.value("benchmark-startup"));
+    }
+    
     return app.exec();
 }
 
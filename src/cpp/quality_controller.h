@@ -0,0 +1,147 @@
+#ifndef QUALITY_CONTROLLER_H
+#define QUALITY_CONTROLLER_H
+
+#include "visualizer_scene.h"
+
+#include <algorithm>
+
+// Picks a SceneQuality level that keeps frames inside a time budget.
+//
+// Frames are evaluated in windows. A window is over budget when rendering
+// uses most of the budget (mean frame cost), or when frames arrive late
+// (mean interval above the target interval); one such window steps quality
+// down. The target interval is the budget, but never shorter than the
+// display's refresh interval: vsync caps the frame rate there (e.g. an
+// 8.3 ms budget on a 60 Hz display), which less detail can't fix. Stepping
+// up needs several consecutive windows with plenty of headroom. A level that
+// failed is blocked for a cooldown that doubles on each repeated failure, so
+// the controller settles instead of oscillating between two levels.
+class AdaptiveQualityController {
+public:
+    static constexpr int kLevelCount = 5;
+    static constexpr int kDefaultLevel = 2; // The original fixed geometry
+
+    explicit AdaptiveQualityController(float budgetMs = 16.6f, int initialLevel = kDefaultLevel)
+        : budgetMs_(budgetMs > 0.0f ? budgetMs : 16.6f),
+          level_(std::clamp(initialLevel, 0, kLevelCount - 1)) {}
+
+    float budgetMs() const { return budgetMs_; }
+    void setBudgetMs(float budgetMs) {
+        if (budgetMs > 0.0f) {
+            budgetMs_ = budgetMs;
+            resetWindow();
+        }
+    }
+
+    // Refresh interval of the display being drawn to, in ms; 0 if unknown
+    float displayIntervalMs() const { return displayIntervalMs_; }
+    void setDisplayIntervalMs(float intervalMs) { displayIntervalMs_ = std::max(intervalMs, 0.0f); }
+
+    // When disabled the current level is kept regardless of frame times
+    bool isAdaptive() const { return adaptive_; }
+    void setAdaptive(bool adaptive) { adaptive_ = adaptive; resetWindow(); }
+
+    int level() const { return level_; }
+    void setLevel(int level) { level_ = std::clamp(level, 0, kLevelCount - 1); resetWindow(); }
+
+    SceneQuality quality() const { return qualityForLevel(level_); }
+
+    static SceneQuality qualityForLevel(int level) {
+        SceneQuality q;
+        switch (std::clamp(level, 0, kLevelCount - 1)) {
+        case 0: q.waveformPoints = 51;  q.numBars = 8;   q.numParticles = 0;   q.circleSegments = 12; break;
+        case 1: q.waveformPoints = 101; q.numBars = 16;  q.numParticles = 20;  q.circleSegments = 20; break;
+        case 2: break; // Defaults
+        case 3: q.waveformPoints = 401; q.numBars = 64;  q.numParticles = 150; q.circleSegments = 48; q.glow = true; break;
+        case 4: q.waveformPoints = 801; q.numBars = 128; q.numParticles = 400; q.circleSegments = 64; q.glow = true; break;
+        }
+        return q;
+    }
+
+    // Feed one frame: time since the previous frame and what the frame cost
+    // to render (including the GPU or software rasterizer finishing it),
+    // both in ms, plus a monotonic clock in seconds. Returns true when the
+    // level changed.
+    bool addFrame(float intervalMs, float workMs, double nowSeconds) {
+        if (!adaptive_) {
+            return false;
+        }
+
+        intervalSum_ += intervalMs;
+        workSum_ += workMs;
+        if (++windowFrames_ < kWindowFrames) {
+            return false;
+        }
+
+        float meanInterval = intervalSum_ / windowFrames_;
+        float meanWork = workSum_ / windowFrames_;
+        resetWindow();
+
+        float targetInterval = std::max(budgetMs_, displayIntervalMs_);
+        bool overBudget = meanInterval > targetInterval * kLateFactor || meanWork > budgetMs_ * kBusyFactor;
+        bool headroom = meanInterval <= targetInterval * kOnTimeFactor && meanWork < budgetMs_ * kIdleFactor;
+
+        if (overBudget) {
+            goodWindows_ = 0;
+            if (level_ == 0) {
+                return false;
+            }
+
+            // Back off from this level; repeated failures wait longer
+            cooldownSeconds_ = (blockedLevel_ == level_) ? std::min(cooldownSeconds_ * 2.0, kMaxCooldownSeconds)
+                                                         : kMinCooldownSeconds;
+            blockedLevel_ = level_;
+            blockedUntil_ = nowSeconds + cooldownSeconds_;
+            --level_;
+            return true;
+        }
+
+        if (!headroom) {
+            goodWindows_ = 0;
+            return false;
+        }
+
+        if (++goodWindows_ < kUpgradeWindows || level_ >= kLevelCount - 1) {
+            return false;
+        }
+        if (level_ + 1 >= blockedLevel_ && nowSeconds < blockedUntil_) {
+            return false;
+        }
+
+        goodWindows_ = 0;
+        ++level_;
+        return true;
+    }
+
+private:
+    static constexpr int kWindowFrames = 30;
+    static constexpr int kUpgradeWindows = 3;
+    static constexpr float kLateFactor = 1.15f;   // Frames arriving this late are misses
+    static constexpr float kBusyFactor = 0.85f;   // Rendering this much of the budget is too much
+    static constexpr float kOnTimeFactor = 1.05f;
+    static constexpr float kIdleFactor = 0.4f;    // Headroom needed before adding detail
+    static constexpr double kMinCooldownSeconds = 5.0;
+    static constexpr double kMaxCooldownSeconds = 120.0;
+
+    float budgetMs_;
+    float displayIntervalMs_ = 0.0f;
+    int level_;
+    bool adaptive_ = true;
+
+    int windowFrames_ = 0;
+    float intervalSum_ = 0.0f;
+    float workSum_ = 0.0f;
+    int goodWindows_ = 0;
+
+    int blockedLevel_ = kLevelCount; // Lowest level that recently missed the budget
+    double blockedUntil_ = 0.0;
+    double cooldownSeconds_ = kMinCooldownSeconds;
+
+    void resetWindow() {
+        windowFrames_ = 0;
+        intervalSum_ = 0.0f;
+        workSum_ = 0.0f;
+    }
+};
+
+#endif // QUALITY_CONTROLLER_H
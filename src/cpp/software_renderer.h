@@ -0,0 +1,263 @@
+#ifndef SOFTWARE_RENDERER_H
+#define SOFTWARE_RENDERER_H
+
+#include "visualizer_scene.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// CPU rasterizer for the visualizer scene. Needs no GL context or display,
+// so frames can be produced on headless, GPU-less machines.
+//
+// Draw calls are recorded into a list of flat-colored triangles in pixel
+// space. endFrame() splits the framebuffer into square tiles and hands them
+// out to worker threads; each tile replays the whole triangle list in
+// submission order, which keeps alpha blending identical to the GL path
+// (GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA) while tiles never share pixels.
+// Like GL, a top-left fill rule draws each pixel of a shared edge once.
+class SoftwareRenderer : public SceneCanvas {
+public:
+    SoftwareRenderer(int width, int height, int threadCount = 0, int tileSize = 64)
+        : width_(std::max(1, width)), height_(std::max(1, height)),
+          tileSize_(std::max(8, tileSize)),
+          pixels_(static_cast<size_t>(width_) * height_ * 4, 0) {
+        threadCount_ = threadCount > 0 ? threadCount : (int)std::thread::hardware_concurrency();
+        threadCount_ = std::max(1, threadCount_);
+    }
+
+    int width() const { return width_; }
+    int height() const { return height_; }
+
+    // Tightly packed RGBA8, top row first
+    const uint8_t* pixels() const { return pixels_.data(); }
+
+    void beginFrame(const SceneColor& clearColor) {
+        clearColor_ = clearColor;
+        triangles_.clear();
+    }
+
+    void endFrame() {
+        int tilesX = (width_ + tileSize_ - 1) / tileSize_;
+        int tilesY = (height_ + tileSize_ - 1) / tileSize_;
+        int tileCount = tilesX * tilesY;
+
+        std::atomic<int> nextTile(0);
+        auto worker = [&]() {
+            for (int tile = nextTile++; tile < tileCount; tile = nextTile++) {
+                int x0 = (tile % tilesX) * tileSize_;
+                int y0 = (tile / tilesX) * tileSize_;
+                rasterizeTile(x0, y0, std::min(x0 + tileSize_, width_), std::min(y0 + tileSize_, height_));
+            }
+        };
+
+        int workers = std::min(threadCount_, tileCount);
+        std::vector<std::thread> threads;
+        threads.reserve(workers - 1);
+        for (int i = 1; i < workers; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    void drawLineStrip(const std::vector<ScenePoint>& points, const SceneColor& color, float width) override {
+        float halfWidth = width * 0.5f;
+
+        for (size_t i = 1; i < points.size(); ++i) {
+            float ax, ay, bx, by;
+            toPixel(points[i - 1], ax, ay);
+            toPixel(points[i], bx, by);
+
+            float dx = bx - ax;
+            float dy = by - ay;
+            float length = std::sqrt(dx * dx + dy * dy);
+            if (length <= 0.0f) {
+                continue;
+            }
+
+            // Offset perpendicular to the segment to give it pixel width
+            float nx = -dy / length * halfWidth;
+            float ny = dx / length * halfWidth;
+            addQuad(ax + nx, ay + ny, bx + nx, by + ny, bx - nx, by - ny, ax - nx, ay - ny, color);
+        }
+    }
+
+    void drawTriangleFan(const std::vector<ScenePoint>& points, const SceneColor& color) override {
+        if (points.size() < 3) {
+            return;
+        }
+
+        float cx, cy;
+        toPixel(points[0], cx, cy);
+        for (size_t i = 2; i < points.size(); ++i) {
+            float ax, ay, bx, by;
+            toPixel(points[i - 1], ax, ay);
+            toPixel(points[i], bx, by);
+            addTriangle(cx, cy, ax, ay, bx, by, color);
+        }
+    }
+
+    void drawQuad(const ScenePoint (&corners)[4], const SceneColor& color) override {
+        float px[4], py[4];
+        for (int i = 0; i < 4; ++i) {
+            toPixel(corners[i], px[i], py[i]);
+        }
+        addQuad(px[0], py[0], px[1], py[1], px[2], py[2], px[3], py[3], color);
+    }
+
+    void drawPoints(const std::vector<ScenePoint>& points, const std::vector<SceneColor>& colors, float size) override {
+        float half = size * 0.5f;
+
+        for (size_t i = 0; i < points.size() && i < colors.size(); ++i) {
+            // Square points, like GL without point smoothing
+            float x, y;
+            toPixel(points[i], x, y);
+            addQuad(x - half, y - half, x + half, y - half, x + half, y + half, x - half, y + half, colors[i]);
+        }
+    }
+
+private:
+    struct Triangle {
+        float x[3];
+        float y[3];
+        int minX, minY, maxX, maxY; // Pixel bounding box, inclusive
+        bool ownsEdge[3];           // Top-left rule: pixel centers exactly on edge i are drawn
+        SceneColor color;
+    };
+
+    int width_;
+    int height_;
+    int tileSize_;
+    int threadCount_;
+    std::vector<uint8_t> pixels_;
+    SceneColor clearColor_ = { 0.0f, 0.0f, 0.0f, 1.0f };
+    std::vector<Triangle> triangles_;
+
+    void toPixel(const ScenePoint& p, float& x, float& y) const {
+        x = (p.x + 1.0f) * 0.5f * width_;
+        y = (1.0f - p.y) * 0.5f * height_;
+    }
+
+    void addQuad(float x0, float y0, float x1, float y1, float x2, float y2, float x3, float y3, const SceneColor& color) {
+        addTriangle(x0, y0, x1, y1, x2, y2, color);
+        addTriangle(x0, y0, x2, y2, x3, y3, color);
+    }
+
+    void addTriangle(float x0, float y0, float x1, float y1, float x2, float y2, const SceneColor& color) {
+        if (color.a <= 0.0f) {
+            return;
+        }
+
+        Triangle tri;
+        tri.x[0] = x0; tri.y[0] = y0;
+        tri.x[1] = x1; tri.y[1] = y1;
+        tri.x[2] = x2; tri.y[2] = y2;
+
+        // Normalize winding so the edge functions are positive inside
+        float area = (x1 - x0) * (y2 - y0) - (y1 - y0) * (x2 - x0);
+        if (area == 0.0f) {
+            return;
+        }
+        if (area < 0.0f) {
+            std::swap(tri.x[1], tri.x[2]);
+            std::swap(tri.y[1], tri.y[2]);
+        }
+
+        // Edge i is opposite vertex i. With y pointing down and this winding,
+        // top edges run in +x and left edges run in -y; triangles sharing an
+        // edge traverse it in opposite directions, so exactly one owns it and
+        // split quads do not blend their diagonal twice.
+        for (int i = 0; i < 3; ++i) {
+            int a = (i + 1) % 3, b = (i + 2) % 3;
+            float dx = tri.x[b] - tri.x[a];
+            float dy = tri.y[b] - tri.y[a];
+            tri.ownsEdge[i] = dy < 0.0f || (dy == 0.0f && dx > 0.0f);
+        }
+
+        tri.minX = std::max(0, (int)std::floor(std::min({ x0, x1, x2 })));
+        tri.minY = std::max(0, (int)std::floor(std::min({ y0, y1, y2 })));
+        tri.maxX = std::min(width_ - 1, (int)std::ceil(std::max({ x0, x1, x2 })));
+        tri.maxY = std::min(height_ - 1, (int)std::ceil(std::max({ y0, y1, y2 })));
+        if (tri.minX > tri.maxX || tri.minY > tri.maxY) {
+            return;
+        }
+
+        tri.color = {
+            std::clamp(color.r, 0.0f, 1.0f),
+            std::clamp(color.g, 0.0f, 1.0f),
+            std::clamp(color.b, 0.0f, 1.0f),
+            std::clamp(color.a, 0.0f, 1.0f)
+        };
+        triangles_.push_back(tri);
+    }
+
+    static float edge(float ax, float ay, float bx, float by, float px, float py) {
+        return (bx - ax) * (py - ay) - (by - ay) * (px - ax);
+    }
+
+    // Renders [x0, x1) x [y0, y1) in float RGBA, then stores it as RGBA8
+    void rasterizeTile(int x0, int y0, int x1, int y1) {
+        int tileWidth = x1 - x0;
+        std::vector<float> tile(static_cast<size_t>(tileWidth) * (y1 - y0) * 4);
+        for (size_t i = 0; i < tile.size(); i += 4) {
+            tile[i + 0] = clearColor_.r;
+            tile[i + 1] = clearColor_.g;
+            tile[i + 2] = clearColor_.b;
+            tile[i + 3] = clearColor_.a;
+        }
+
+        for (const Triangle& tri : triangles_) {
+            int minX = std::max(tri.minX, x0);
+            int maxX = std::min(tri.maxX, x1 - 1);
+            int minY = std::max(tri.minY, y0);
+            int maxY = std::min(tri.maxY, y1 - 1);
+            if (minX > maxX || minY > maxY) {
+                continue;
+            }
+
+            const SceneColor& c = tri.color;
+            float inverseAlpha = 1.0f - c.a;
+
+            for (int y = minY; y <= maxY; ++y) {
+                float py = y + 0.5f;
+                float* row = &tile[(static_cast<size_t>(y - y0) * tileWidth) * 4];
+
+                for (int x = minX; x <= maxX; ++x) {
+                    float px = x + 0.5f;
+                    // Sample at pixel centers
+                    float w0 = edge(tri.x[1], tri.y[1], tri.x[2], tri.y[2], px, py);
+                    float w1 = edge(tri.x[2], tri.y[2], tri.x[0], tri.y[0], px, py);
+                    float w2 = edge(tri.x[0], tri.y[0], tri.x[1], tri.y[1], px, py);
+                    if (w0 < 0.0f || w1 < 0.0f || w2 < 0.0f ||
+                        (w0 == 0.0f && !tri.ownsEdge[0]) ||
+                        (w1 == 0.0f && !tri.ownsEdge[1]) ||
+                        (w2 == 0.0f && !tri.ownsEdge[2])) {
+                        continue;
+                    }
+
+                    float* dst = &row[(x - x0) * 4];
+                    dst[0] = c.r * c.a + dst[0] * inverseAlpha;
+                    dst[1] = c.g * c.a + dst[1] * inverseAlpha;
+                    dst[2] = c.b * c.a + dst[2] * inverseAlpha;
+                    dst[3] = c.a + dst[3] * inverseAlpha; // Coverage, so opaque frames stay opaque
+                }
+            }
+        }
+
+        for (int y = y0; y < y1; ++y) {
+            const float* src = &tile[(static_cast<size_t>(y - y0) * tileWidth) * 4];
+            uint8_t* dst = &pixels_[(static_cast<size_t>(y) * width_ + x0) * 4];
+            for (int i = 0; i < tileWidth * 4; ++i) {
+                dst[i] = (uint8_t)(std::clamp(src[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+            }
+        }
+    }
+};
+
+#endif // SOFTWARE_RENDERER_H
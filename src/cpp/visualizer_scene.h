@@ -0,0 +1,191 @@
+#ifndef VISUALIZER_SCENE_H
+#define VISUALIZER_SCENE_H
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+
+// Backend-independent description of the visualizer scene. The geometry is
+// generated here once and replayed by whichever canvas draws it, so the
+// OpenGL widget and the headless software renderer produce the same picture.
+// Coordinates are normalized device coordinates in [-1, 1], y pointing up.
+
+struct ScenePoint {
+    float x;
+    float y;
+};
+
+struct SceneColor {
+    float r;
+    float g;
+    float b;
+    float a;
+};
+
+// Geometry detail; the defaults are the original fixed amounts
+struct SceneQuality {
+    int waveformPoints = 201;  // Vertices across the waveform line strip
+    int numBars = 32;          // Frequency bars
+    int numParticles = 50;     // Mood particles
+    int circleSegments = 32;   // Beat indicator segments
+    bool glow = false;         // Soft wide pass under the waveform
+};
+
+struct VisualizerSceneState {
+    float time = 0.0f;          // Seconds since the animation started
+    float beatIntensity = 0.0f; // 1.0 on a beat, decays towards 0
+    float tempo = 120.0f;       // BPM driving animation speed and beat rate
+    float energy = 1.0f;        // Loudness scale for waveform and bars, 1.0 without analysis
+    float moodR = 0.0f;         // Mood color, default green
+    float moodG = 1.0f;
+    float moodB = 0.5f;
+    SceneQuality quality;
+    std::vector<float> spectrum; // Measured band levels 0..1 (live input); empty = animated bars
+};
+
+// Interface implemented by each render backend
+class SceneCanvas {
+public:
+    virtual ~SceneCanvas() = default;
+
+    virtual void drawLineStrip(const std::vector<ScenePoint>& points, const SceneColor& color, float width) = 0;
+    virtual void drawTriangleFan(const std::vector<ScenePoint>& points, const SceneColor& color) = 0;
+    virtual void drawQuad(const ScenePoint (&corners)[4], const SceneColor& color) = 0;
+    virtual void drawPoints(const std::vector<ScenePoint>& points, const std::vector<SceneColor>& colors, float size) = 0;
+};
+
+// Mood name to base color, shared by the UI and the headless renderer
+inline bool visualizerMoodColor(const std::string& mood, float& r, float& g, float& b) {
+    if (mood == "happy") { r = 1.0f; g = 0.7f; b = 0.0f; }
+    else if (mood == "sad") { r = 0.2f; g = 0.3f; b = 0.8f; }
+    else if (mood == "energetic") { r = 1.0f; g = 0.0f; b = 0.3f; }
+    else if (mood == "calm") { r = 0.3f; g = 0.8f; b = 0.5f; }
+    else if (mood == "angry") { r = 0.9f; g = 0.1f; b = 0.1f; }
+    else return false;
+    return true;
+}
+
+// Background clear color for the current mood
+inline SceneColor visualizerBackground(const VisualizerSceneState& state) {
+    return { state.moodR * 0.1f, state.moodG * 0.1f, state.moodB * 0.1f, 1.0f };
+}
+
+// One animation tick (~16 ms): beat decay plus tempo-driven beat trigger
+inline void stepVisualizerBeat(VisualizerSceneState& state) {
+    state.beatIntensity *= 0.98f;
+
+    float beatInterval = 60.0f / state.tempo; // Convert BPM to seconds per beat
+    if (std::fmod(state.time, beatInterval) < 0.1f && state.beatIntensity < 0.5f) {
+        state.beatIntensity = 1.0f;
+    }
+}
+
+// One animation tick driven by detected beat events instead of the tempo grid
+inline void stepVisualizerBeat(VisualizerSceneState& state, bool beatEvent) {
+    state.beatIntensity *= 0.98f;
+
+    if (beatEvent) {
+        state.beatIntensity = 1.0f;
+    }
+}
+
+inline void drawSceneWaveform(const VisualizerSceneState& state, SceneCanvas& canvas) {
+    float tempoMultiplier = state.tempo / 120.0f; // Normalize to 120 BPM
+
+    int numPoints = std::max(2, state.quality.waveformPoints);
+
+    std::vector<ScenePoint> points;
+    points.reserve(numPoints);
+    for (int i = 0; i < numPoints; ++i) {
+        float x = -1.0f + 2.0f * i / (numPoints - 1);
+        float y = 0.3f * std::sin(x * 10.0f + state.time * 3.0f * tempoMultiplier) * (1.0f + state.beatIntensity * 0.5f) * state.energy;
+        points.push_back({ x, y });
+    }
+
+    if (state.quality.glow) {
+        canvas.drawLineStrip(points, { state.moodR, state.moodG, state.moodB, 0.2f }, 8.0f);
+    }
+    canvas.drawLineStrip(points, { state.moodR, state.moodG, state.moodB, 0.8f }, 2.0f);
+}
+
+inline void drawSceneBeatIndicator(const VisualizerSceneState& state, SceneCanvas& canvas) {
+    if (state.beatIntensity <= 0.1f) {
+        return;
+    }
+
+    float radius = 0.05f + 0.1f * state.beatIntensity;
+    int segments = std::max(3, state.quality.circleSegments);
+
+    std::vector<ScenePoint> points;
+    points.reserve(segments + 2);
+    points.push_back({ 0.0f, 0.8f });
+    for (int i = 0; i <= segments; ++i) {
+        float angle = i * 2.0f * M_PI / segments;
+        points.push_back({ radius * std::cos(angle), 0.8f + radius * std::sin(angle) });
+    }
+
+    canvas.drawTriangleFan(points, { 1.0f, 1.0f, 1.0f, state.beatIntensity });
+}
+
+inline void drawSceneFrequencyBars(const VisualizerSceneState& state, SceneCanvas& canvas) {
+    int numBars = std::max(1, state.quality.numBars);
+    float barWidth = 2.0f / numBars;
+    float tempoMultiplier = state.tempo / 120.0f;
+    float phaseStep = 0.3f * 32.0f / numBars; // Same wave shape at any bar count
+
+    for (int i = 0; i < numBars; ++i) {
+        float intensity = 0.3f + 0.5f * std::sin(i * phaseStep + state.time * 2.0f * tempoMultiplier);
+        if (!state.spectrum.empty()) {
+            intensity = 0.05f + 0.75f * state.spectrum[i * state.spectrum.size() / numBars];
+        }
+        intensity *= (1.0f + state.beatIntensity * 0.5f) * state.energy;
+
+        float x = -1.0f + i * barWidth;
+        float height = intensity * 0.6f;
+
+        // Color based on frequency (blue to red across spectrum)
+        float colorPhase = (float)i / numBars;
+        ScenePoint corners[4] = {
+            { x, -0.8f },
+            { x + barWidth * 0.8f, -0.8f },
+            { x + barWidth * 0.8f, -0.8f + height },
+            { x, -0.8f + height }
+        };
+        canvas.drawQuad(corners, { colorPhase * state.moodR, (1.0f - colorPhase) * state.moodG, state.moodB, 0.7f });
+    }
+}
+
+inline void drawSceneMoodParticles(const VisualizerSceneState& state, SceneCanvas& canvas) {
+    int numParticles = state.quality.numParticles;
+    if (numParticles <= 0) {
+        return;
+    }
+
+    std::vector<ScenePoint> points;
+    std::vector<SceneColor> colors;
+    points.reserve(numParticles);
+    colors.reserve(numParticles);
+
+    for (int i = 0; i < numParticles; ++i) {
+        float t = state.time + i * 0.1f;
+        float x = std::sin(t * 0.5f + i) * 0.8f;
+        float y = std::sin(t * 0.3f + i * 2.0f) * 0.8f;
+        float alpha = (0.5f + 0.5f * std::sin(t * 2.0f + i)) * state.beatIntensity;
+
+        points.push_back({ x, y });
+        colors.push_back({ state.moodR, state.moodG, state.moodB, alpha * 0.5f });
+    }
+
+    canvas.drawPoints(points, colors, 3.0f);
+}
+
+// Draw all layers in the same order as the on-screen visualizer
+inline void drawVisualizerScene(const VisualizerSceneState& state, SceneCanvas& canvas) {
+    drawSceneWaveform(state, canvas);
+    drawSceneBeatIndicator(state, canvas);
+    drawSceneFrequencyBars(state, canvas);
+    drawSceneMoodParticles(state, canvas);
+}
+
+#endif // VISUALIZER_SCENE_H
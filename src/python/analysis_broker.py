@@ -0,0 +1,365 @@
+import zmq
+import json
+import time
+import threading
+import multiprocessing as mp
+from collections import deque
+
+# Commands served on the interactive lane. Everything else is batch work.
+INTERACTIVE_COMMANDS = {"analyze_chunk"}
+
+# Appended to a worker's identity for its heartbeat socket
+HEARTBEAT_SUFFIX = b"/heartbeat"
+
+
+def _heartbeat_loop(context, identity, backend_address, interval, stop):
+    """Sends HEARTBEAT on a second socket until stop is set, including while
+    the worker is still loading or busy with a job."""
+    socket = context.socket(zmq.DEALER)
+    socket.setsockopt(zmq.IDENTITY, identity + HEARTBEAT_SUFFIX)
+    socket.setsockopt(zmq.LINGER, 0)
+    socket.connect(backend_address)
+    try:
+        while True:
+            socket.send_multipart([b"HEARTBEAT"])
+            if stop.wait(interval):
+                break
+    finally:
+        socket.close()
+
+
+def _worker_main(identity, backend_address, heartbeat_interval):
+    """Worker process: runs AnalysisServer.process_request for jobs from the broker."""
+    context = zmq.Context()
+    stop = threading.Event()
+    heartbeat = threading.Thread(target=_heartbeat_loop, daemon=True,
+                                 args=(context, identity, backend_address, heartbeat_interval, stop))
+    heartbeat.start()
+
+    socket = context.socket(zmq.DEALER)
+    socket.setsockopt(zmq.IDENTITY, identity)
+    socket.setsockopt(zmq.LINGER, 0)
+    socket.connect(backend_address)
+
+    try:
+        # Imported here so each worker builds its own analyzer; all load the same cached model
+        from src.python.analysis_server import AnalysisServer
+
+        server = AnalysisServer()
+        socket.send_multipart([b"READY"])
+
+        while True:
+            frames = socket.recv_multipart()
+            if frames[0] == b"STOP":
+                break
+
+            client_id, payload = frames[0], frames[1]
+            try:
+                response = server.process_request(json.loads(payload))
+            except Exception as e:
+                response = {"status": "error", "message": str(e)}
+
+            socket.send_multipart([b"REPLY", client_id, json.dumps(response).encode()])
+    finally:
+        stop.set()
+        heartbeat.join()
+        socket.close()
+        context.term()
+
+
+class LaneMetrics:
+    """Queue wait and service time samples for one priority lane."""
+
+    def __init__(self, max_samples=1000):
+        self.completed = 0
+        self.rejected = 0
+        self.failed = 0
+        self.queue_wait = deque(maxlen=max_samples)
+        self.service_time = deque(maxlen=max_samples)
+
+    @staticmethod
+    def _summary(samples):
+        if not samples:
+            return {"count": 0, "mean_ms": 0.0, "p95_ms": 0.0, "max_ms": 0.0}
+        ordered = sorted(samples)
+        p95 = ordered[min(len(ordered) - 1, int(len(ordered) * 0.95))]
+        return {
+            "count": len(ordered),
+            "mean_ms": 1000.0 * sum(ordered) / len(ordered),
+            "p95_ms": 1000.0 * p95,
+            "max_ms": 1000.0 * ordered[-1],
+        }
+
+    def to_dict(self, queue_depth):
+        return {
+            "queue_depth": queue_depth,
+            "completed": self.completed,
+            "rejected": self.rejected,
+            "failed": self.failed,
+            "queue_wait": self._summary(self.queue_wait),
+            "service_time": self._summary(self.service_time),
+        }
+
+
+class WorkerHandle:
+    """Broker-side state of one worker process."""
+
+    def __init__(self, index):
+        self.index = index
+        self.generation = 0
+        self.identity = None
+        self.process = None
+        self.ready = False
+        self.job = None  # (client_id, lane, enqueued_at, started_at)
+        self.spawned_at = 0.0
+        self.last_seen = 0.0
+        self.restarts = 0
+
+
+class AnalysisBroker:
+    """ROUTER broker in front of a pool of AnalysisServer worker processes.
+
+    Clients keep using a plain REQ socket on the public port. Requests are
+    queued in two lanes: interactive (analyze_chunk) is always dispatched
+    before batch (analyze_file), and batch jobs may never occupy the last
+    reserved_interactive workers, so chunk requests do not wait behind long
+    file analyses. Each lane has a depth limit; requests beyond it are
+    rejected immediately with a "busy" error instead of queueing unbounded.
+
+    Workers are restarted when they exit, miss heartbeats (sent from a
+    separate thread, so also while loading or busy), are not READY within
+    startup_timeout, or run a job past its lane's timeout. The interactive
+    timeout is short so a stuck chunk does not hold the reserved worker.
+    """
+
+    def __init__(self, port=5555, num_workers=2, backend_port=None,
+                 max_interactive_queue=32, max_batch_queue=16,
+                 reserved_interactive=1, interactive_timeout=10.0, batch_timeout=300.0,
+                 startup_timeout=120.0, heartbeat_interval=1.0, heartbeat_timeout=10.0):
+        self.port = port
+        self.backend_address = f"tcp://127.0.0.1:{backend_port or port + 1}"
+        self.num_workers = max(1, num_workers)
+        self.max_queue = {"interactive": max_interactive_queue, "batch": max_batch_queue}
+        self.reserved_interactive = min(reserved_interactive, self.num_workers - 1)
+        self.job_timeouts = {"interactive": interactive_timeout, "batch": batch_timeout}
+        self.startup_timeout = startup_timeout
+        self.heartbeat_interval = heartbeat_interval
+        self.heartbeat_timeout = heartbeat_timeout
+
+        self.queues = {"interactive": deque(), "batch": deque()}
+        self.metrics = {"interactive": LaneMetrics(), "batch": LaneMetrics()}
+        self.workers = [WorkerHandle(i) for i in range(self.num_workers)]
+        self.by_identity = {}
+        self.started_at = time.monotonic()
+
+        self.context = None
+        self.frontend = None
+        self.backend = None
+        self.running = True
+
+    def start(self):
+        """Bind the sockets, spawn the workers and run the broker loop."""
+        self.context = zmq.Context()
+        self.frontend = self.context.socket(zmq.ROUTER)
+        self.frontend.bind(f"tcp://*:{self.port}")
+        self.backend = self.context.socket(zmq.ROUTER)
+        self.backend.bind(self.backend_address)
+
+        for worker in self.workers:
+            self._spawn(worker)
+
+        print(f"Analysis broker started on port {self.port} with {self.num_workers} workers")
+
+        poller = zmq.Poller()
+        poller.register(self.frontend, zmq.POLLIN)
+        poller.register(self.backend, zmq.POLLIN)
+
+        while self.running:
+            events = dict(poller.poll(100))
+
+            if self.backend in events:
+                self._handle_backend(self.backend.recv_multipart())
+
+            if self.frontend in events:
+                self._handle_frontend(self.frontend.recv_multipart())
+
+            self._check_workers()
+            self._dispatch()
+
+    def stop(self):
+        """Stop the broker and all worker processes."""
+        self.running = False
+
+        for worker in self.workers:
+            if worker.process is None:
+                continue
+            if worker.ready and self.backend is not None:
+                self.backend.send_multipart([worker.identity, b"STOP"])
+            worker.process.join(timeout=2.0)
+            if worker.process.is_alive():
+                worker.process.terminate()
+                worker.process.join()
+
+        if self.context is not None:
+            self.frontend.close(linger=0)
+            self.backend.close(linger=0)
+            self.context.term()
+            self.context = None
+
+    def stats(self):
+        """Current queue, metrics and worker health snapshot."""
+        now = time.monotonic()
+        return {
+            "uptime": now - self.started_at,
+            "lanes": {
+                lane: self.metrics[lane].to_dict(len(self.queues[lane]))
+                for lane in self.queues
+            },
+            "workers": [
+                {
+                    "index": w.index,
+                    "pid": w.process.pid if w.process else None,
+                    "ready": w.ready,
+                    "busy": w.job is not None,
+                    "lane": w.job[1] if w.job else None,
+                    "busy_for": now - w.job[3] if w.job else 0.0,
+                    "restarts": w.restarts,
+                }
+                for w in self.workers
+            ],
+        }
+
+    def _spawn(self, worker):
+        worker.generation += 1
+        worker.identity = f"worker-{worker.index}-{worker.generation}".encode()
+        worker.ready = False
+        worker.job = None
+        worker.spawned_at = time.monotonic()
+        worker.last_seen = worker.spawned_at
+        worker.process = mp.Process(
+            target=_worker_main,
+            args=(worker.identity, self.backend_address, self.heartbeat_interval),
+            daemon=True,
+        )
+        worker.process.start()
+        self.by_identity[worker.identity] = worker
+        self.by_identity[worker.identity + HEARTBEAT_SUFFIX] = worker
+
+    def _restart(self, worker, reason):
+        print(f"Restarting worker {worker.index}: {reason}")
+
+        if worker.job is not None:
+            client_id, lane, _, _ = worker.job
+            self.metrics[lane].failed += 1
+            self._reply(client_id, {"status": "error", "message": f"Worker failed: {reason}"})
+
+        if worker.process.is_alive():
+            worker.process.terminate()
+        worker.process.join(timeout=2.0)
+
+        del self.by_identity[worker.identity]
+        del self.by_identity[worker.identity + HEARTBEAT_SUFFIX]
+        worker.restarts += 1
+        self._spawn(worker)
+
+    def _check_workers(self):
+        now = time.monotonic()
+        for worker in self.workers:
+            if not worker.process.is_alive():
+                self._restart(worker, f"exited with code {worker.process.exitcode}")
+            elif now - worker.last_seen > self.heartbeat_timeout:
+                self._restart(worker, "missed heartbeats")
+            elif not worker.ready and now - worker.spawned_at > self.startup_timeout:
+                self._restart(worker, f"not ready after {self.startup_timeout:.0f}s")
+            elif worker.job is not None and now - worker.job[3] > self.job_timeouts[worker.job[1]]:
+                lane = worker.job[1]
+                self._restart(worker, f"{lane} job exceeded {self.job_timeouts[lane]:.0f}s")
+
+    def _handle_backend(self, frames):
+        worker = self.by_identity.get(frames[0])
+        if worker is None:
+            return  # Late message from a restarted worker
+
+        worker.last_seen = time.monotonic()
+        kind = frames[1]
+
+        if kind == b"READY":
+            worker.ready = True
+        elif kind == b"REPLY" and worker.job is not None:
+            client_id, lane, _, started_at = worker.job
+            worker.job = None
+            metrics = self.metrics[lane]
+            metrics.completed += 1
+            metrics.service_time.append(time.monotonic() - started_at)
+            self.frontend.send_multipart([client_id, b"", frames[3]])
+
+    def _handle_frontend(self, frames):
+        client_id, payload = frames[0], frames[-1]
+
+        try:
+            request = json.loads(payload)
+            command = request.get("command")
+        except (ValueError, AttributeError):
+            self._reply(client_id, {"status": "error", "message": "Malformed request"})
+            return
+
+        # Control commands are answered by the broker itself
+        if command == "stats":
+            self._reply(client_id, {"status": "success", "data": self.stats()})
+            return
+        if command == "stop":
+            self._reply(client_id, {"status": "stopping"})
+            self.running = False
+            return
+
+        lane = "interactive" if command in INTERACTIVE_COMMANDS else "batch"
+        queue = self.queues[lane]
+        if len(queue) >= self.max_queue[lane]:
+            self.metrics[lane].rejected += 1
+            self._reply(client_id, {
+                "status": "error",
+                "message": f"Server busy: {lane} queue full ({len(queue)} pending)",
+                "busy": True,
+            })
+            return
+
+        queue.append((client_id, payload, time.monotonic()))
+
+    def _dispatch(self):
+        idle = [w for w in self.workers if w.ready and w.job is None]
+        batch_capacity = (self.num_workers - self.reserved_interactive
+                          - sum(1 for w in self.workers if w.job and w.job[1] == "batch"))
+
+        for worker in idle:
+            if self.queues["interactive"]:
+                lane = "interactive"
+            elif self.queues["batch"] and batch_capacity > 0:
+                lane = "batch"
+                batch_capacity -= 1
+            else:
+                break
+
+            client_id, payload, enqueued_at = self.queues[lane].popleft()
+            now = time.monotonic()
+            self.metrics[lane].queue_wait.append(now - enqueued_at)
+            worker.job = (client_id, lane, enqueued_at, now)
+            self.backend.send_multipart([worker.identity, client_id, payload])
+
+    def _reply(self, client_id, response):
+        self.frontend.send_multipart([client_id, b"", json.dumps(response).encode()])
+
+
+def main():
+    """Start the analysis broker with a worker pool."""
+    broker = AnalysisBroker()
+
+    try:
+        broker.start()
+    except KeyboardInterrupt:
+        print("\nShutting down broker...")
+    finally:
+        broker.stop()
+
+
+if __name__ == "__main__":
+    main()
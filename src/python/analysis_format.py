@@ -0,0 +1,187 @@
+"""
+Binary container (.mva) for the analysis of one track.
+
+Layout (little-endian):
+    header          64 bytes, see HEADER
+    section table   section_count entries of 64 bytes, see SECTION
+    section data    typed arrays, each starting on a 64-byte boundary
+
+Each section is a flat array of float32 (or uint8 for text) described by its
+table entry, so readers map the file and use the arrays in place: the C++
+app through src/cpp/analysis_file.h, Python through read_analysis(), which
+returns numpy views over a memory map.
+
+Versioning: readers accept any minor version of the major version they
+know and skip section kinds they do not recognize. Adding a section kind or
+using a reserved field bumps the minor version; anything that changes the
+meaning of existing bytes bumps the major version.
+"""
+
+import os
+import struct
+import numpy as np
+
+MAGIC = b"MVAF"
+VERSION_MAJOR = 1
+VERSION_MINOR = 0
+ALIGNMENT = 64
+
+# magic, version major/minor, header size, section count, section table
+# offset, file size, duration, sample rate, tempo, mood index, mood
+# confidence, 2 reserved
+HEADER = struct.Struct("<4sHHIIQQdIfif8x")
+
+# kind, data type, offset, count, rate, start time, param, reserved, name
+SECTION = struct.Struct("<IIQQffI4x24s")
+
+# Section kinds
+EVENTS = 1              # float32 sorted times in seconds (beats, bars, onsets)
+SERIES = 2              # float32 values at `rate` per second from `start_time`
+WAVEFORM_LEVEL = 3      # float32 min/max pairs per bin; param = samples per bin
+MOOD_PROBABILITIES = 4  # float32 per mood, in MOOD_NAMES order
+MOOD_NAMES = 5          # uint8 NUL-terminated UTF-8 names
+VECTOR = 6              # float32 values without a time axis (chroma_mean)
+
+# Data types
+FLOAT32 = 1
+UINT8 = 2
+
+_DTYPES = {FLOAT32: np.dtype("<f4"), UINT8: np.dtype("u1")}
+
+assert HEADER.size == 64 and SECTION.size == 64
+
+
+def _align(offset):
+    return (offset + ALIGNMENT - 1) // ALIGNMENT * ALIGNMENT
+
+
+def write_analysis(path, analysis, mood=None):
+    """Write an analyze_audio_file() result, plus an optional predict_mood()
+    result, to path. The file is written next to path and renamed into
+    place, so readers never see a partial container."""
+    beats = analysis.get("beats", {})
+    features = analysis.get("features", {})
+    frame_rate = features.get("frame_rate", 0.0)
+
+    # (kind, data type, array, rate, start time, param, name)
+    sections = [
+        (EVENTS, FLOAT32, beats.get("beat_times", []), 0.0, 0.0, 0, "beats"),
+        (EVENTS, FLOAT32, beats.get("bar_times", []), 0.0, 0.0, 0, "bars"),
+        (EVENTS, FLOAT32, features.get("onset_times", []), 0.0, 0.0, 0, "onsets"),
+        (SERIES, FLOAT32, analysis.get("waveform", []), analysis.get("waveform_rate", 0.0), 0.0, 0, "waveform"),
+        (SERIES, FLOAT32, features.get("rms_energy", []), frame_rate, 0.0, 0, "rms"),
+        (SERIES, FLOAT32, features.get("spectral_centroids", []), frame_rate, 0.0, 0, "spectral_centroid"),
+        (VECTOR, FLOAT32, features.get("chroma_mean", []), 0.0, 0.0, 0, "chroma_mean"),
+    ]
+
+    sample_rate = analysis.get("sample_rate", 0)
+    for level in analysis.get("waveform_pyramid", []):
+        samples_per_bin = level["samples_per_bin"]
+        sections.append((WAVEFORM_LEVEL, FLOAT32, level["min_max"],
+                         sample_rate / samples_per_bin if sample_rate else 0.0,
+                         0.0, samples_per_bin, f"waveform_{samples_per_bin}"))
+
+    mood_index = -1
+    mood_confidence = 0.0
+    if mood and mood.get("probabilities"):
+        names = list(mood["probabilities"].keys())
+        probabilities = [mood["probabilities"][name] for name in names]
+        text = b"".join(name.encode("utf-8") + b"\0" for name in names)
+        sections.append((MOOD_PROBABILITIES, FLOAT32, probabilities, 0.0, 0.0, 0, "mood"))
+        sections.append((MOOD_NAMES, UINT8, np.frombuffer(text, dtype=np.uint8), 0.0, 0.0, 0, "mood"))
+        if mood.get("predicted_mood") in names:
+            mood_index = names.index(mood["predicted_mood"])
+        mood_confidence = mood.get("confidence", 0.0)
+
+    arrays = [np.ascontiguousarray(np.asarray(data).ravel(), dtype=_DTYPES[dtype])
+              for _, dtype, data, *_ in sections]
+
+    table_offset = HEADER.size
+    offset = _align(table_offset + SECTION.size * len(sections))
+    entries = []
+    offsets = []
+    for (kind, dtype, _, rate, start_time, param, name), array in zip(sections, arrays):
+        encoded = name.encode("utf-8")
+        if len(encoded) > 24:
+            raise ValueError(f"Section name too long: {name}")
+        entries.append(SECTION.pack(kind, dtype, offset, array.size, rate, start_time, param, encoded))
+        offsets.append(offset)
+        offset = _align(offset + array.nbytes)
+    file_size = offset
+
+    header = HEADER.pack(MAGIC, VERSION_MAJOR, VERSION_MINOR, HEADER.size, len(sections),
+                         table_offset, file_size, float(analysis.get("duration", 0.0)), int(sample_rate),
+                         float(beats.get("tempo", 0.0)), mood_index, float(mood_confidence))
+
+    temp_path = f"{path}.{os.getpid()}.tmp"  # Workers may write the same track at once
+    with open(temp_path, "wb") as f:
+        f.write(header)
+        f.write(b"".join(entries))
+        for offset, array in zip(offsets, arrays):
+            f.seek(offset)
+            f.write(array.tobytes())
+        f.truncate(file_size)
+    os.replace(temp_path, path)
+
+
+class AnalysisFile:
+    """Read-only view of a .mva container. Arrays are numpy views over a
+    memory map and stay valid as long as this object is alive."""
+
+    def __init__(self, path):
+        self._data = np.memmap(path, dtype=np.uint8, mode="r")
+        if self._data.size < HEADER.size:
+            raise ValueError(f"{path}: too small for an analysis file")
+
+        (magic, major, minor, header_size, section_count, table_offset, file_size,
+         self.duration, self.sample_rate, self.tempo, mood_index,
+         self.mood_confidence) = HEADER.unpack_from(self._data)
+        if magic != MAGIC:
+            raise ValueError(f"{path}: not an analysis file")
+        if major != VERSION_MAJOR:
+            raise ValueError(f"{path}: unsupported version {major}.{minor}")
+        if file_size != self._data.size or table_offset + section_count * SECTION.size > file_size:
+            raise ValueError(f"{path}: truncated")
+        self.version = (major, minor)
+
+        self.events = {}
+        self.series = {}       # name -> (values, rate, start_time)
+        self.vectors = {}
+        self.waveform_levels = []  # (min_max with shape (bins, 2), samples_per_bin), finest first
+        self.mood_probabilities = {}
+        probabilities = None
+        names = []
+
+        for i in range(section_count):
+            kind, dtype, offset, count, rate, start_time, param, name = \
+                SECTION.unpack_from(self._data, table_offset + i * SECTION.size)
+            if dtype not in _DTYPES:
+                continue
+            element = _DTYPES[dtype]
+            if offset % element.itemsize or offset + count * element.itemsize > file_size:
+                raise ValueError(f"{path}: section {i} out of bounds")
+
+            array = self._data[offset:offset + count * element.itemsize].view(element)
+            name = name.rstrip(b"\0").decode("utf-8")
+            if kind == EVENTS:
+                self.events[name] = array
+            elif kind == SERIES:
+                self.series[name] = (array, rate, start_time)
+            elif kind == VECTOR:
+                self.vectors[name] = array
+            elif kind == WAVEFORM_LEVEL:
+                self.waveform_levels.append((array.reshape(-1, 2), param))
+            elif kind == MOOD_PROBABILITIES:
+                probabilities = array
+            elif kind == MOOD_NAMES:
+                names = [n.decode("utf-8") for n in array.tobytes().split(b"\0")[:-1]]
+
+        self.waveform_levels.sort(key=lambda level: level[1])
+        if probabilities is not None and len(names) == len(probabilities):
+            self.mood_probabilities = dict(zip(names, probabilities.tolist()))
+        self.predicted_mood = names[mood_index] if 0 <= mood_index < len(names) else None
+
+
+def read_analysis(path):
+    """Open a .mva container written by write_analysis()."""
+    return AnalysisFile(path)
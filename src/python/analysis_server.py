@@ -1,22 +1,29 @@
 import zmq
+import os
 import json
+import hashlib
 import threading
 import numpy as np
 from src.python.audio_analyzer import AudioAnalyzer
-from src.python.mood_classifier import MoodClassifier
+from src.python.model_cache import get_cache_dir, load_mood_classifier
+from src.python.analysis_format import write_analysis
 import time
 
 class AnalysisServer:
-    def __init__(self, port=5555):
+    def __init__(self, port=5555, analyses_dir=None):
         self.port = port
-        self.context = zmq.Context()
-        self.socket = self.context.socket(zmq.REP)
+        # Analysis files are only ever written here, under names the server picks
+        self.analyses_dir = analyses_dir or os.path.join(get_cache_dir(), "analyses")
+        self.context = None
+        self.socket = None
         self.analyzer = AudioAnalyzer()
-        self.classifier = MoodClassifier()
+        self.classifier = load_mood_classifier()  # Same persisted model in every worker
         self.running = True
     
     def start(self):
         """Start the analysis server."""
+        self.context = zmq.Context()
+        self.socket = self.context.socket(zmq.REP)
         self.socket.bind(f"tcp://*:{self.port}")
         print(f"Analysis server started on port {self.port}")
         
@@ -41,7 +48,7 @@ class AnalysisServer:
         
         if command == "analyze_file":
             file_path = request.get("file_path")
-            return self.analyze_audio_file(file_path)
+            return self.analyze_audio_file(file_path, request.get("write_file", False))
         
         elif command == "analyze_chunk":
             audio_data = np.array(request.get("audio_data"))
@@ -55,8 +62,13 @@ class AnalysisServer:
         else:
             return {"status": "error", "message": f"Unknown command: {command}"}
     
-    def analyze_audio_file(self, file_path):
-        """Analyze an audio file and return results."""
+    def analyze_audio_file(self, file_path, write_file=False):
+        """Analyze an audio file and return results.
+        
+        With write_file the full results are written as a binary analysis
+        file (.mva) in analyses_dir and the reply only carries the summary
+        and the file's path.
+        """
         try:
             # Load and analyze audio
             audio_data, sr = self.analyzer.load_audio(file_path)
@@ -72,6 +84,27 @@ class AnalysisServer:
             # Get mood prediction
             mood_result = self.classifier.predict_mood(audio_data, sr)
             
+            if write_file:
+                analysis = {
+                    "duration": float(len(audio_data) / sr),
+                    "sample_rate": sr,
+                    "beats": beats,
+                    "features": features,
+                    "waveform": waveform,
+                    "waveform_rate": self.analyzer.get_waveform_rate(audio_data),
+                    "waveform_pyramid": self.analyzer.get_waveform_pyramid(audio_data)
+                }
+                output_path = self.analysis_path(file_path)
+                write_analysis(output_path, analysis, mood_result)
+                return {
+                    "status": "success",
+                    "data": {
+                        "duration": analysis["duration"],
+                        "sample_rate": sr,
+                        "output_path": output_path
+                    }
+                }
+            
             return {
                 "status": "success",
                 "data": {
@@ -80,6 +113,7 @@ class AnalysisServer:
                     "beats": beats,
                     "features": features,
                     "waveform": waveform,
+                    "waveform_rate": self.analyzer.get_waveform_rate(audio_data),
                     "mood": mood_result
                 }
             }
@@ -87,6 +121,13 @@ class AnalysisServer:
         except Exception as e:
             return {"status": "error", "message": str(e)}
     
+    def analysis_path(self, file_path):
+        """Analysis file for a track: named by a hash of its absolute path,
+        so clients never choose where the server writes."""
+        os.makedirs(self.analyses_dir, exist_ok=True)
+        key = hashlib.sha1(os.path.abspath(file_path).encode("utf-8")).hexdigest()
+        return os.path.join(self.analyses_dir, f"{key}.mva")
+    
     def analyze_audio_chunk(self, audio_data, sample_rate):
         """Analyze a chunk of audio data (for real-time processing)."""
         try:
@@ -115,8 +156,9 @@ class AnalysisServer:
     def stop(self):
         """Stop the server."""
         self.running = False
-        self.socket.close()
-        self.context.term()
+        if self.socket is not None:
+            self.socket.close()
+            self.context.term()
 
 def main():
     """Start the analysis server."""
@@ -26,9 +26,13 @@ class AudioAnalyzer:
         # Convert beat frames to time
         beat_times = librosa.frames_to_time(beat_frames, sr=self.sample_rate)
         
+        # Bar downbeats, assuming 4/4 time starting on the first detected beat
+        bar_times = beat_times[::4]
+        
         return {
             "tempo": float(tempo),
             "beat_times": beat_times.tolist(),
+            "bar_times": bar_times.tolist(),
             "beat_count": len(beat_frames)
         }
     
@@ -48,6 +52,8 @@ class AudioAnalyzer:
         chroma = librosa.feature.chroma_stft(y=audio_data, sr=self.sample_rate)
         
         return {
+            # Frame-based series use librosa's default hop of 512 samples
+            "frame_rate": float(self.sample_rate / 512),
             "spectral_centroids": spectral_centroids.tolist(),
             "rms_energy": rms.tolist(),
             "onset_times": onset_times.tolist(),
@@ -64,24 +70,68 @@ class AudioAnalyzer:
         downsampled = [np.mean(audio_data[i:i+chunk_size]) for i in range(0, len(audio_data), chunk_size)]
         return downsampled[:num_points]
     
-    def analyze_audio_file(self, file_path: str) -> Dict:
-        """Complete analysis of an audio file."""
+    def get_waveform_rate(self, audio_data: np.ndarray, num_points: int = 1000) -> float:
+        """Points per second of the data returned by get_waveform_data."""
+        chunk_size = max(1, len(audio_data) // num_points)
+        return float(self.sample_rate / chunk_size)
+    
+    def get_waveform_pyramid(self, audio_data: np.ndarray, base_samples: int = 256,
+                             factor: int = 4, min_bins: int = 256) -> List[Dict]:
+        """Min/max envelope at several zoom levels, finest first.
+        
+        Each level has one (min, max) pair per samples_per_bin samples, so a
+        waveform view can draw any zoom from the level closest to one bin per
+        pixel instead of scanning raw audio.
+        """
+        def reduce(values, group):
+            # Pad the last group with its own final value so it does not skew min/max
+            bins = max(1, -(-len(values) // group))
+            padded = np.empty((bins * group,) + values.shape[1:], dtype=np.float32)
+            padded[:len(values)] = values
+            padded[len(values):] = values[-1] if len(values) else 0.0
+            return padded.reshape((bins, group) + values.shape[1:])
+        
+        chunks = reduce(np.asarray(audio_data, dtype=np.float32), base_samples)
+        min_max = np.stack([chunks.min(axis=1), chunks.max(axis=1)], axis=1)
+        levels = [{"samples_per_bin": base_samples, "min_max": min_max}]
+        
+        # Coarser levels combine bins of the previous level instead of rescanning the audio
+        while len(min_max) > min_bins:
+            groups = reduce(min_max, factor)
+            min_max = np.stack([groups[:, :, 0].min(axis=1), groups[:, :, 1].max(axis=1)], axis=1)
+            levels.append({"samples_per_bin": levels[-1]["samples_per_bin"] * factor, "min_max": min_max})
+        return levels
+    
+    def analyze_audio_file(self, file_path: str, include_pyramid: bool = False) -> Dict:
+        """Complete analysis of an audio file.
+        
+        include_pyramid adds "waveform_pyramid" (numpy arrays, for the binary
+        container); it is off by default to keep the result JSON-serializable.
+        """
         audio_data, sr = self.load_audio(file_path)
         
         if audio_data is None:
             return {"error": "Failed to load audio file"}
         
+        return self.analyze_audio(audio_data, sr, include_pyramid)
+    
+    def analyze_audio(self, audio_data: np.ndarray, sr: int, include_pyramid: bool = False) -> Dict:
+        """Complete analysis of already decoded audio at this analyzer's sample rate."""
         beats = self.detect_beats(audio_data)
         features = self.extract_features(audio_data)
         waveform = self.get_waveform_data(audio_data)
         
-        return {
+        result = {
             "sample_rate": sr,
             "duration": float(len(audio_data) / sr),
             "beats": beats,
             "features": features,
-            "waveform": waveform
+            "waveform": waveform,
+            "waveform_rate": self.get_waveform_rate(audio_data)
         }
+        if include_pyramid:
+            result["waveform_pyramid"] = self.get_waveform_pyramid(audio_data)
+        return result
     
     def plot_analysis(self, analysis_data: Dict, save_path: str = None):
         """Visualize the analysis results."""
@@ -0,0 +1,44 @@
+import os
+
+
+def get_cache_dir():
+    """Persistent cache for JIT artifacts and model state shared across launches."""
+    base = os.environ.get("LOCALAPPDATA") or os.path.join(os.path.expanduser("~"), ".cache")
+    path = os.environ.get("MUSIC_VISUALIZER_CACHE", os.path.join(base, "AI-Music-Visualizer"))
+    os.makedirs(path, exist_ok=True)
+    return path
+
+
+def load_mood_classifier():
+    """Mood classifier with model state persisted in the cache directory.
+    
+    Every process (CLI, app worker, server pool workers) loads the same
+    file, so a track gets the same mood whichever process classifies it.
+    The first process to run creates the file; concurrent first runs all
+    end up loading the one that was published first.
+    """
+    # Imported here because torch takes seconds to load
+    from src.python.mood_classifier import MoodClassifier
+    
+    model_path = os.path.join(get_cache_dir(), "mood_model.pt")
+    if os.path.exists(model_path):
+        try:
+            return MoodClassifier(model_path)
+        except Exception as e:
+            print(f"Ignoring unreadable model cache: {e}")
+            os.remove(model_path)
+    
+    temp_path = f"{model_path}.{os.getpid()}.tmp"
+    MoodClassifier().save_model(temp_path)
+    try:
+        # Publish without overwriting a model another process already published
+        os.link(temp_path, model_path)
+    except FileExistsError:
+        pass
+    except OSError:
+        os.replace(temp_path, model_path)  # No hard links on this file system
+    finally:
+        if os.path.exists(temp_path):
+            os.remove(temp_path)
+    
+    return MoodClassifier(model_path)
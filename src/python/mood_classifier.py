@@ -186,7 +186,8 @@ class MoodClassifier:
 
     def load_model(self, path: str):
         """Load a trained model and scaler."""
-        checkpoint = torch.load(path)
+        # The checkpoint also holds the fitted scaler, which is not a tensor
+        checkpoint = torch.load(path, weights_only=False)
         self.model.load_state_dict(checkpoint["model_state_dict"])
         self.scaler = checkpoint["scaler"]
         self.model.eval()